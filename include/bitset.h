@@ -0,0 +1,154 @@
+/*!
+ * \file bitset.h
+ * \author twoflyliu
+ * \version v0.0.6
+ * \date 2026年10月19日19:16:08
+ * \copyright GNU Public License V3.0
+ * \brief 此文件中声明了位集合bitset_t的所有api函数。
+ *
+ * bitset_t每个元素只占用一个位，按照64位的字保存。和使用char_vec/int_vec保存标志相比，内存是它们的1/8到1/32，
+ * 集合运算和计数每次处理一个字。
+ *
+ * 计数在支持popcnt指令的x86 cpu上运行时选择使用硬件指令，查找下一个置位使用__builtin_ctzll(对应bsf/tzcnt指令)。
+ */
+
+#ifndef BITSET_H_H
+#define BITSET_H_H
+
+#include <assert.h>
+
+#include "cstl_stddef.h"
+
+#define BITSET_WORD_BITS 64 //!< 每个字的位数
+
+/*!
+ * \brief 一个可以改变尺寸的位集合
+ *
+ * 最后一个字中超过nbits的位总是0。
+ */
+typedef struct {
+    uint64_t *words;    //!< 保存所有位的字，第i位在第i/64个字的第i%64位
+    size_t nbits;       //!< 位的数目
+} bitset_t, BITSET;
+
+/*!
+ * \brief 新建一个有nbits个位的bitset_t实例，所有的位都是0
+ * \retval 新的bitset实例，不再使用的时候需要调用bitset_free
+ */
+CSTL_LIB bitset_t *bitset_new(size_t nbits);
+
+CSTL_LIB void bitset_free(bitset_t *bitset);
+
+/*!
+ * \brief 复制一个bitset_t实例
+ */
+CSTL_LIB bitset_t *bitset_clone(const bitset_t *bitset);
+
+/*!
+ * \brief 返回位的数目
+ */
+CSTL_LIB size_t bitset_size(const bitset_t *bitset);
+
+/*!
+ * \brief 改变位的数目，新增加的位都是0
+ */
+CSTL_LIB void bitset_resize(bitset_t *bitset, size_t nbits);
+
+//// 单个位的操作，index必须小于bitset_size，否则断言失败
+
+static inline void bitset_set(bitset_t *bitset, size_t index) {
+    assert(bitset && index < bitset->nbits);
+    bitset->words[index / BITSET_WORD_BITS] |= (uint64_t)1 << (index % BITSET_WORD_BITS);
+}
+
+static inline void bitset_reset(bitset_t *bitset, size_t index) {
+    assert(bitset && index < bitset->nbits);
+    bitset->words[index / BITSET_WORD_BITS] &= ~((uint64_t)1 << (index % BITSET_WORD_BITS));
+}
+
+static inline void bitset_flip(bitset_t *bitset, size_t index) {
+    assert(bitset && index < bitset->nbits);
+    bitset->words[index / BITSET_WORD_BITS] ^= (uint64_t)1 << (index % BITSET_WORD_BITS);
+}
+
+static inline bool bitset_test(const bitset_t *bitset, size_t index) {
+    assert(bitset && index < bitset->nbits);
+    return (bitset->words[index / BITSET_WORD_BITS] >> (index % BITSET_WORD_BITS)) & 1;
+}
+
+static inline void bitset_assign(bitset_t *bitset, size_t index, bool value) {
+    if (value) {
+        bitset_set(bitset, index);
+    } else {
+        bitset_reset(bitset, index);
+    }
+}
+
+/*!
+ * \brief 将[from, to)范围内的位都设置为1，中间整个的字一次设置
+ */
+CSTL_LIB void bitset_set_range(bitset_t *bitset, size_t from, size_t to);
+
+/*!
+ * \brief 将[from, to)范围内的位都设置为0，中间整个的字一次设置
+ */
+CSTL_LIB void bitset_reset_range(bitset_t *bitset, size_t from, size_t to);
+
+CSTL_LIB void bitset_set_all(bitset_t *bitset);
+
+CSTL_LIB void bitset_reset_all(bitset_t *bitset);
+
+CSTL_LIB void bitset_flip_all(bitset_t *bitset);
+
+/*!
+ * \brief 返回值为1的位的数目
+ */
+CSTL_LIB size_t bitset_count(const bitset_t *bitset);
+
+/*!
+ * \brief 是否有值为1的位
+ */
+CSTL_LIB bool bitset_any(const bitset_t *bitset);
+
+/*!
+ * \brief 两个bitset的尺寸和所有位是否都相同
+ */
+CSTL_LIB bool bitset_equals(const bitset_t *lhs, const bitset_t *rhs);
+
+/*!
+ * \brief 返回第一个值为1的位的索引，不存在的时候返回bitset_size(bitset)
+ */
+CSTL_LIB size_t bitset_find_first(const bitset_t *bitset);
+
+/*!
+ * \brief 返回索引大于等于from的第一个值为1的位的索引，不存在的时候返回bitset_size(bitset)
+ *
+ * 遍历所有值为1的位：
+ *
+ *     for (size_t i = bitset_find_first(bs); i < bitset_size(bs); i = bitset_find_next(bs, i + 1))
+ */
+CSTL_LIB size_t bitset_find_next(const bitset_t *bitset, size_t from);
+
+//// 集合运算，结果保存到dst中，dst和src的尺寸必须相同，否则断言失败
+
+/*!
+ * \brief dst = dst & src
+ */
+CSTL_LIB void bitset_and(bitset_t *dst, const bitset_t *src);
+
+/*!
+ * \brief dst = dst | src
+ */
+CSTL_LIB void bitset_or(bitset_t *dst, const bitset_t *src);
+
+/*!
+ * \brief dst = dst ^ src
+ */
+CSTL_LIB void bitset_xor(bitset_t *dst, const bitset_t *src);
+
+/*!
+ * \brief dst = dst & ~src，也就是从dst中去掉src中的元素
+ */
+CSTL_LIB void bitset_andnot(bitset_t *dst, const bitset_t *src);
+
+#endif //BITSET_H_H
@@ -188,6 +188,12 @@ CSTL_LIB int __cstl_long_long_hash_func(const long long *value);
 #   define UNUSED //!<一个空的宏
 #endif
 
+#if defined(__GNUC__)
+#   define CSTL_PREFETCH(addr) __builtin_prefetch(addr) //!<一个辅助宏，提示cpu预先将addr所在的内存读入缓存
+#else
+#   define CSTL_PREFETCH(addr) //!<一个空的宏
+#endif
+
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -0,0 +1,123 @@
+/*!
+ * \file deque.h
+ * \author twoflyliu
+ * \version v0.0.6
+ * \date 2026年10月19日18:02:37
+ * \copyright GNU Public License V3.0
+ * \brief 此文件中声明了双端队列deque_t的所有api函数。
+ *
+ * deque_t使用一块环形的连续内存保存元素，首尾两端的插入和删除都是均摊O(1)的，并且不会移动其他元素，
+ * 按照索引访问也是O(1)的。和vec_push_front/vec_pop_front相比不需要挪动整个数组，
+ * 和list_t相比不需要为每个元素分配一次内存。
+ *
+ * 容量总是2的幂，内存用完的时候容量翻倍，此时元素会被复制到新的内存中，之前获取的元素地址都会失效。
+ */
+
+#ifndef DEQUE_H_H
+#define DEQUE_H_H
+
+#include "cstl_stddef.h"
+
+/*!
+ * \brief 一个双端队列容器，类似于c++中的deque
+ */
+typedef struct {
+    void *beg;                      //!< 环形缓冲区的起始地址
+    size_t head;                    //!< 第一个元素在缓冲区中的位置
+    size_t len;                     //!< 元素的数目
+    size_t capacity;                //!< 缓冲区最多可以存放的元素数目，总是2的幂
+    size_t unit_size;               //!< 单个元素的内存尺寸
+    destroy_func_t destroy_func;    //!< 元素的销毁函数
+} deque_t, DEQUE;
+
+/*!
+ * \brief deque_foreach的回调函数
+ * \param [in,out] value 当前元素的地址
+ * \param [in,out] user_data 用户传递的数据
+ */
+typedef void (*DEQUE_FOREACH_FUNC)(void *value, void *user_data);
+typedef DEQUE_FOREACH_FUNC deque_foreach_func_t; //!< DEQUE_FOREACH_FUNC别名，主要用来统一的类型命名
+
+/*!
+ * \brief 新建一个空的deque_t实例
+ * \param [in] unit_size 单个元素的内存尺寸
+ * \param [in] destroy 元素的销毁函数，可以为NULL
+ * \retval 新的deque实例，不再使用的时候需要调用deque_free
+ */
+CSTL_LIB deque_t *deque_new(size_t unit_size, destroy_func_t destroy);
+
+/*!
+ * \brief 新建一个空的deque_t实例，并且预先分配至少可以存放capacity个元素的内存
+ */
+CSTL_LIB deque_t *deque_new_with_capacity(size_t unit_size, destroy_func_t destroy, size_t capacity);
+
+/*!
+ * \brief 销毁deque以及其中所有的元素
+ */
+CSTL_LIB void deque_free(deque_t *deque);
+
+CSTL_LIB size_t deque_size(const deque_t *deque);
+
+CSTL_LIB bool deque_empty(const deque_t *deque);
+
+CSTL_LIB size_t deque_capacity(const deque_t *deque);
+
+/*!
+ * \brief 保证至少可以存放capacity个元素，之后元素数目不超过capacity的插入都不会分配内存
+ */
+CSTL_LIB void deque_reserve(deque_t *deque, size_t capacity);
+
+/*!
+ * \brief 在队列头部插入一个元素，均摊时间复杂度O(1)
+ */
+CSTL_LIB void deque_push_front(deque_t *deque, const void *elem);
+
+/*!
+ * \brief 在队列尾部插入一个元素，均摊时间复杂度O(1)
+ */
+CSTL_LIB void deque_push_back(deque_t *deque, const void *elem);
+
+/*!
+ * \brief 移除队列头部的元素，时间复杂度O(1)
+ * \param [in,out] deque deque_t实例，不能为空
+ * \param [out] result 如果不为NULL，元素被复制到这里，所有权转移给调用者，不会调用销毁函数；否则使用销毁函数销毁元素
+ */
+CSTL_LIB void deque_pop_front(deque_t *deque, void *result);
+
+/*!
+ * \brief 移除队列尾部的元素，时间复杂度O(1)
+ * \param [out] result 和deque_pop_front相同
+ */
+CSTL_LIB void deque_pop_back(deque_t *deque, void *result);
+
+/*!
+ * \brief 获取队列头部的元素，队列为空时候返回NULL
+ */
+CSTL_LIB void *deque_front(deque_t *deque);
+
+/*!
+ * \brief 获取队列尾部的元素，队列为空时候返回NULL
+ */
+CSTL_LIB void *deque_back(deque_t *deque);
+
+/*!
+ * \brief 获取索引为index的元素，索引0是队列头部，index超出范围的时候返回NULL，时间复杂度O(1)
+ */
+CSTL_LIB void *deque_get(deque_t *deque, size_t index);
+
+/*!
+ * \brief 使用value替换索引为index的元素，原来的元素会被销毁，index超出范围的时候什么也不做
+ */
+CSTL_LIB void deque_set(deque_t *deque, size_t index, const void *value);
+
+/*!
+ * \brief 销毁所有的元素，保留已经分配的内存
+ */
+CSTL_LIB void deque_clear(deque_t *deque);
+
+/*!
+ * \brief 从头部到尾部依次遍历所有的元素
+ */
+CSTL_LIB void deque_foreach(deque_t *deque, deque_foreach_func_t foreach_func, void *user_data);
+
+#endif //DEQUE_H_H
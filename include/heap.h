@@ -0,0 +1,133 @@
+/*!
+ * \file heap.h
+ * \author twoflyliu
+ * \version v0.0.6
+ * \date 2026年10月19日17:20:46
+ * \copyright GNU Public License V3.0
+ * \brief 此文件中声明了优先队列heap_t的所有api函数。
+ *
+ * heap_t使用vec_t的连续内存保存元素，元素按照4叉堆的顺序排列：
+ * 第i个元素的子节点是4i+1到4i+4，父节点是(i-1)/4。和二叉堆相比树的高度减半，
+ * 一个节点的所有子节点通常位于同一个缓存行中，所以调整堆的时候缓存缺失更少。
+ *
+ * 堆顶是比较函数认为最小的元素，如果需要最大堆，传入相反的比较函数即可。
+ */
+
+#ifndef HEAP_H_H
+#define HEAP_H_H
+
+#include "vec.h"
+
+/*!
+ * \brief 元素位置改变时候的回调函数类型
+ * \param [in,out] value 元素的地址
+ * \param [in] index 元素在堆中新的索引
+ *
+ * 调用者可以在回调中记录元素当前的索引，之后使用这个索引调用heap_decrease_key, heap_update和heap_remove。
+ * 比如元素是定时器的指针，那么可以把索引保存到定时器结构体中。
+ */
+typedef void (*HEAP_INDEX_FUNC)(void *value, size_t index);
+typedef HEAP_INDEX_FUNC heap_index_func_t; //!< HEAP_INDEX_FUNC别名，主要用来统一的类型命名
+
+/*!
+ * \brief 优先队列
+ */
+typedef struct {
+    VEC *data;                      //!< 按照4叉堆的顺序保存所有元素
+    cmp_func_t cmp_func;            //!< 元素的比较函数
+    destroy_func_t destroy_func;    //!< 元素的销毁函数，可以为NULL
+    heap_index_func_t index_func;   //!< 元素位置改变时候的回调函数，可以为NULL
+    void *tmp;                      //!< 调整堆的时候暂存一个元素
+} heap_t, HEAP;
+
+/*!
+ * \brief 新建一个空的heap_t实例
+ * \param [in] unit_size 元素占用内存的尺寸
+ * \param [in] cmp_func 元素的比较函数，堆顶是最小的元素
+ * \param [in] destroy_func 元素的销毁函数，可以为NULL
+ * \retval 返回的heap实例，不再使用的时候需要调用heap_free
+ */
+CSTL_LIB heap_t *heap_new(int unit_size, cmp_func_t cmp_func, destroy_func_t destroy_func);
+
+/*!
+ * \brief 使用一个已经存在的vec新建heap_t实例，时间复杂度O(n)
+ * \param [in] vec 保存元素的vec，heap会接管vec以及它的销毁函数，调用者之后不能再使用和释放vec
+ * \param [in] cmp_func 元素的比较函数，堆顶是最小的元素
+ * \retval 返回的heap实例，不再使用的时候需要调用heap_free
+ */
+CSTL_LIB heap_t *heap_new_from_vec(VEC *vec, cmp_func_t cmp_func);
+
+/*!
+ * \brief 销毁heap以及其中所有的元素
+ */
+CSTL_LIB void heap_free(heap_t *heap);
+
+/*!
+ * \brief 设置元素位置改变时候的回调函数，设置的时候会为所有已经存在的元素调用一次
+ */
+CSTL_LIB void heap_set_index_func(heap_t *heap, heap_index_func_t index_func);
+
+/*!
+ * \brief 插入一个元素，时间复杂度O(log n)
+ */
+CSTL_LIB void heap_push(heap_t *heap, const void *value);
+
+/*!
+ * \brief 获取堆顶的元素，heap为空时候返回NULL
+ * \note 不能通过返回的指针修改元素的顺序，如果修改了需要调用heap_update(heap, 0)
+ */
+CSTL_LIB void *heap_top(heap_t *heap);
+
+/*!
+ * \brief 移除堆顶的元素，时间复杂度O(log n)
+ * \param [in,out] heap heap_t实例，不能为空
+ * \param [out] result 如果不为NULL，则堆顶的元素被复制到这里，元素的所有权转移给调用者，不会调用销毁函数；
+ * 否则使用销毁函数销毁堆顶的元素
+ */
+CSTL_LIB void heap_pop(heap_t *heap, void *result);
+
+/*!
+ * \brief 使用value替换堆顶的元素，比heap_pop之后再heap_push少一次调整
+ * \param [in,out] heap heap_t实例，不能为空
+ * \param [in] value 新的元素
+ * \param [out] result 和heap_pop相同
+ */
+CSTL_LIB void heap_replace_top(heap_t *heap, const void *value, void *result);
+
+/*!
+ * \brief 获取索引为index的元素，索引需要小于heap_size
+ */
+CSTL_LIB void *heap_get(heap_t *heap, size_t index);
+
+/*!
+ * \brief 使用一个不大于原来元素的值替换索引为index的元素，时间复杂度O(log n)
+ * \note 原来的元素被直接覆盖，不会调用销毁函数
+ */
+CSTL_LIB void heap_decrease_key(heap_t *heap, size_t index, const void *value);
+
+/*!
+ * \brief 索引为index的元素被调用者修改之后，调用此函数恢复堆的顺序，时间复杂度O(log n)
+ */
+CSTL_LIB void heap_update(heap_t *heap, size_t index);
+
+/*!
+ * \brief 移除索引为index的元素，时间复杂度O(log n)
+ * \param [out] result 和heap_pop相同
+ */
+CSTL_LIB void heap_remove(heap_t *heap, size_t index, void *result);
+
+/*!
+ * \brief 销毁所有的元素，保留已经分配的内存
+ */
+CSTL_LIB void heap_clear(heap_t *heap);
+
+CSTL_LIB size_t heap_size(const heap_t *heap);
+
+CSTL_LIB bool heap_empty(const heap_t *heap);
+
+/*!
+ * \brief 返回保存元素的vec，元素是按照堆的顺序排列的，调用者不能修改
+ */
+CSTL_LIB const VEC *heap_data(const heap_t *heap);
+
+#endif //HEAP_H_H
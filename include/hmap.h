@@ -124,6 +124,22 @@ CSTL_LIB void hmap_insert(HMAP *hmap, const void *key, const void *value);
  */
 CSTL_LIB void *hmap_get(const HMAP *hmap, const void *key);
 
+/*!
+ *  \brief 使用和key类型不同的probe来获取对应的值
+ *  
+ *  比如以str_t*为key的hmap, 可以使用str_slice_t作为probe, str_slice_hash_code作为probe_hash,
+ *  str_slice_ptr_cmp作为probe_cmp来查找，不需要为了查找而分配临时的str_t。
+ *  
+ *  \param [in] hmap hmap_t实例
+ *  \param [in] probe 用来查找的值的地址
+ *  \param [in] probe_hash probe的hash函数，对于相等的probe和key，它的返回值必须和hmap的hash函数相同
+ *  \param [in] probe_cmp 比较函数，调用方式是probe_cmp(probe, key), 返回0表示相等
+ *  \retval 返回对应的值的指针，如果不存在的话，则返回NULL。
+ *  \note hmap, probe, probe_hash, probe_cmp都不能为NULL, 否则会断言失败。
+ */
+CSTL_LIB void *hmap_get_with(const HMAP *hmap, const void *probe,
+        hash_func_t probe_hash, cmp_func_t probe_cmp);
+
 /*!
  *  \brief 获取一个key对应的值
  *  \param [in] hmap hmap_t实例
@@ -0,0 +1,120 @@
+/*!
+ * \file prmap.h
+ * \author twoflyliu
+ * \version v0.0.6
+ * \date 2026年10月19日10:12:40
+ * \copyright GNU Public License V3.0
+ * \brief 此文件中声明了持久化(不可变)有序关联容器prmap_t的所有api函数。
+ *
+ * prmap_t的每一个实例都是一个不可变的快照，修改操作(prmap_insert, prmap_erase)不会改变原来的快照，
+ * 而是只复制从根节点到修改位置的路径，返回一个新的快照，新老快照共享其余所有的节点。
+ *
+ * 快照使用引用计数来管理，所以读线程可以持有某个快照，在不加锁的情况下进行查找和遍历，
+ * 与此同时一个写线程可以继续生成新的快照，通过prmap_cell_t来发布给读线程。
+ */
+
+#ifndef INCLUDE_PRMAP_H_H
+#define INCLUDE_PRMAP_H_H
+
+#include "cstl_stddef.h"
+
+typedef struct prmap_t prmap_t;
+typedef prmap_t PRMAP;
+
+typedef struct prmap_cell_t prmap_cell_t;
+
+/*!
+ * \brief prmap_for_each和prmap_for_each_range的回调函数类型
+ * \param [in] key 元素的key
+ * \param [in] value 元素的value，因为快照是共享的，所以不能修改
+ * \param [in,out] user_data 用户指定的额外参数
+ */
+typedef void (*PRMAP_FOR_EACH)(const void *key, const void *value, void *user_data);
+
+/*!
+ * \brief 创建一个空的快照
+ * \param [in] key_size key占用内存的尺寸
+ * \param [in] value_size value占用内存的尺寸
+ * \param [in] key_cmp_func key的比较函数
+ * \retval 新的快照，不再使用时要调用prmap_free
+ * \note 因为元素会被多个快照共享，所以prmap_t不支持key和value的销毁函数，
+ * 元素只能是不拥有额外资源的值类型(或者由调用者自己来管理其生命周期)
+ */
+CSTL_LIB prmap_t *prmap_new(size_t key_size, size_t value_size, cmp_func_t key_cmp_func);
+
+/*!
+ * \brief 增加快照的引用计数，此函数是线程安全的
+ * \retval 返回pmap本身
+ */
+CSTL_LIB prmap_t *prmap_ref(prmap_t *pmap);
+
+/*!
+ * \brief 减少快照的引用计数，当引用计数为0的时候，释放掉快照以及不再被其他快照使用的节点，
+ * 此函数是线程安全的
+ */
+CSTL_LIB void prmap_free(prmap_t *pmap);
+
+/*!
+ * \brief 返回插入(key, value)之后的新快照，如果key已经存在则新快照中是新的value
+ * \note pmap本身不会被修改，仍然需要调用者释放。时间复杂度O(log n)
+ */
+CSTL_LIB prmap_t *prmap_insert(const prmap_t *pmap, const void *key, const void *value);
+
+/*!
+ * \brief 返回删除key之后的新快照，如果key不存在，则新快照和pmap内容相同
+ * \note pmap本身不会被修改，仍然需要调用者释放。时间复杂度O(log n)
+ */
+CSTL_LIB prmap_t *prmap_erase(const prmap_t *pmap, const void *key);
+
+/*!
+ * \brief 获取key对应的值的地址，如果不存在返回NULL。返回的地址在pmap被释放前一直有效
+ */
+CSTL_LIB const void *prmap_get(const prmap_t *pmap, const void *key);
+
+CSTL_LIB bool prmap_has_key(const prmap_t *pmap, const void *key);
+
+CSTL_LIB size_t prmap_size(const prmap_t *pmap);
+
+CSTL_LIB bool prmap_empty(const prmap_t *pmap);
+
+/*!
+ * \brief 按照key从小到大的顺序遍历快照中所有的元素
+ */
+CSTL_LIB void prmap_for_each(const prmap_t *pmap, PRMAP_FOR_EACH for_each_func, void *user_data);
+
+/*!
+ * \brief 按照key从小到大的顺序遍历快照中key位于[lo, hi]之间的元素
+ */
+CSTL_LIB void prmap_for_each_range(const prmap_t *pmap, const void *lo, const void *hi,
+        PRMAP_FOR_EACH for_each_func, void *user_data);
+
+// prmap_cell_t 用来在一个写线程和多个读线程之间发布快照
+
+/*!
+ * \brief 创建一个保存当前快照的单元，pmap的引用会转移给这个单元
+ */
+CSTL_LIB prmap_cell_t *prmap_cell_new(prmap_t *pmap);
+
+/*!
+ * \brief 释放单元以及它持有的快照的引用，调用时候不能再有其他线程访问这个单元
+ */
+CSTL_LIB void prmap_cell_free(prmap_cell_t *cell);
+
+/*!
+ * \brief 读线程调用，获取当前快照的一个引用，用完之后需要调用prmap_free
+ *
+ * 获取引用期间只会写自己占用的槽位(每个槽位一个缓存行)，读线程之间以及读线程和写线程之间都不会互相等待，
+ * 只有超过64个线程同时获取引用的时候，多出来的线程才会等待空闲的槽位。
+ * 之后对于快照的所有查找和遍历都不需要任何锁
+ */
+CSTL_LIB prmap_t *prmap_cell_acquire(prmap_cell_t *cell);
+
+/*!
+ * \brief 写线程调用，发布新的快照，pmap的引用会转移给这个单元，原来的快照的引用会被释放
+ *
+ * 不会等待读线程，原来的快照正在被读线程获取引用的时候，推迟到之后的某次发布或者prmap_cell_free再释放
+ * \note 同一时间只能有一个线程调用此函数
+ */
+CSTL_LIB void prmap_cell_publish(prmap_cell_t *cell, prmap_t *pmap);
+
+#endif //INCLUDE_PRMAP_H_H
@@ -0,0 +1,122 @@
+/*!
+ * \file ring_queue.h
+ * \author twoflyliu
+ * \version v0.0.6
+ * \date 2026年10月19日18:40:15
+ * \copyright GNU Public License V3.0
+ * \brief 此文件中声明了用于线程间传递数据的有界无锁队列。
+ *
+ * 和vec_new(unit_size, ...)一样，队列中保存的是固定尺寸的元素，入队和出队都是按值复制。
+ * 队列的容量在创建时候确定(向上取整为2的幂)，之后不会分配任何内存。
+ *
+ * - spsc_queue_t 单生产者单消费者队列，入队和出队都是无等待(wait-free)的。
+ *   同一时间只能有一个线程入队，一个线程出队
+ * - mpmc_queue_t 多生产者多消费者队列(Dmitry Vyukov的有界队列)，每个槽位带有一个序号，
+ *   生产者之间和消费者之间只通过一次CAS竞争位置，不使用任何锁
+ *
+ * 生产者和消费者使用的索引位于不同的缓存行中，避免伪共享。批量操作一次竞争或者发布多个元素，
+ * 分摊原子操作的开销。
+ */
+
+#ifndef RING_QUEUE_H_H
+#define RING_QUEUE_H_H
+
+#include "cstl_stddef.h"
+
+typedef struct spsc_queue_t spsc_queue_t;
+typedef spsc_queue_t SPSC_QUEUE;
+
+typedef struct mpmc_queue_t mpmc_queue_t;
+typedef mpmc_queue_t MPMC_QUEUE;
+
+/*!
+ * \brief 新建一个单生产者单消费者队列
+ * \param [in] unit_size 单个元素的内存尺寸
+ * \param [in] destroy 元素的销毁函数，只在释放队列时候用来销毁还没有出队的元素，可以为NULL
+ * \param [in] capacity 最多可以存放的元素数目，会向上取整为2的幂
+ * \retval 新的队列，不再使用的时候需要调用spsc_queue_free
+ */
+CSTL_LIB spsc_queue_t *spsc_queue_new(size_t unit_size, destroy_func_t destroy, size_t capacity);
+
+/*!
+ * \brief 释放队列以及其中还没有出队的元素，调用时候不能再有其他线程访问这个队列
+ */
+CSTL_LIB void spsc_queue_free(spsc_queue_t *queue);
+
+/*!
+ * \brief 生产者调用，将elem复制到队列尾部
+ * \retval 队列已满的时候返回false，否则返回true
+ */
+CSTL_LIB bool spsc_queue_push(spsc_queue_t *queue, const void *elem);
+
+/*!
+ * \brief 消费者调用，将队列头部的元素复制到result中并且出队
+ * \retval 队列为空的时候返回false，否则返回true
+ */
+CSTL_LIB bool spsc_queue_pop(spsc_queue_t *queue, void *result);
+
+/*!
+ * \brief 生产者调用，将elems中最多count个连续的元素入队
+ * \retval 实际入队的元素数目，队列剩余的空间不够的时候会小于count
+ */
+CSTL_LIB size_t spsc_queue_push_batch(spsc_queue_t *queue, const void *elems, size_t count);
+
+/*!
+ * \brief 消费者调用，最多出队count个元素，依次复制到results中
+ * \retval 实际出队的元素数目
+ */
+CSTL_LIB size_t spsc_queue_pop_batch(spsc_queue_t *queue, void *results, size_t count);
+
+/*!
+ * \brief 返回队列中元素的数目，其他线程同时在操作队列的时候只是一个近似值
+ */
+CSTL_LIB size_t spsc_queue_size(const spsc_queue_t *queue);
+
+CSTL_LIB size_t spsc_queue_capacity(const spsc_queue_t *queue);
+
+/*!
+ * \brief 新建一个多生产者多消费者队列
+ * \param [in] unit_size 单个元素的内存尺寸
+ * \param [in] destroy 元素的销毁函数，只在释放队列时候用来销毁还没有出队的元素，可以为NULL
+ * \param [in] capacity 最多可以存放的元素数目，会向上取整为2的幂，最小是2
+ * \retval 新的队列，不再使用的时候需要调用mpmc_queue_free
+ */
+CSTL_LIB mpmc_queue_t *mpmc_queue_new(size_t unit_size, destroy_func_t destroy, size_t capacity);
+
+/*!
+ * \brief 释放队列以及其中还没有出队的元素，调用时候不能再有其他线程访问这个队列
+ */
+CSTL_LIB void mpmc_queue_free(mpmc_queue_t *queue);
+
+/*!
+ * \brief 将elem复制到队列尾部，可以被多个线程同时调用
+ * \retval 队列已满的时候返回false，否则返回true
+ */
+CSTL_LIB bool mpmc_queue_push(mpmc_queue_t *queue, const void *elem);
+
+/*!
+ * \brief 将队列头部的元素复制到result中并且出队，可以被多个线程同时调用
+ * \retval 队列为空的时候返回false，否则返回true
+ */
+CSTL_LIB bool mpmc_queue_pop(mpmc_queue_t *queue, void *result);
+
+/*!
+ * \brief 将elems中最多count个连续的元素入队，这些元素在队列中是连续的，不会和其他生产者的元素交错
+ * \retval 实际入队的元素数目，队列剩余的空间不够的时候会小于count
+ */
+CSTL_LIB size_t mpmc_queue_push_batch(mpmc_queue_t *queue, const void *elems, size_t count);
+
+/*!
+ * \brief 最多出队count个连续的元素，依次复制到results中
+ * \retval 实际出队的元素数目
+ */
+CSTL_LIB size_t mpmc_queue_pop_batch(mpmc_queue_t *queue, void *results, size_t count);
+
+/*!
+ * \brief 返回队列中元素的数目，其他线程同时在操作队列的时候只是一个近似值
+ */
+CSTL_LIB size_t mpmc_queue_size(const mpmc_queue_t *queue);
+
+CSTL_LIB size_t mpmc_queue_capacity(const mpmc_queue_t *queue);
+
+#endif //RING_QUEUE_H_H
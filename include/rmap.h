@@ -20,22 +20,51 @@ CSTL_LIB rmap_t *rmap_new_with_destroy_func(size_t key_size, size_t value_size,
         key_destroy_func_t key_destroy,
         value_destroy_func_t val_destroy);
 
+// 和rmap_new_with_destroy_func一样，但是内部会维护每个子树的尺寸，
+// 只有使用它创建的rmap才能调用rmap_rank, rmap_select, rmap_count_range
+CSTL_LIB rmap_t *rmap_new_with_rank(size_t key_size, size_t value_size, 
+        key_cmp_func_t key_cmp_func,
+        key_destroy_func_t key_destroy,
+        value_destroy_func_t val_destroy);
+
 CSTL_LIB void rmap_free(rmap_t *rmap);
 
 CSTL_LIB void rmap_insert(rmap_t *rmap, const void *key, const void *value);
 
+// 如果key不存在，则插入(key, value)；如果已经存在，则不修改原来的值。
+// 返回key所对应值的地址，*inserted用来表示是否是新插入的(inserted可以为NULL)
+CSTL_LIB void *rmap_get_or_insert(rmap_t *rmap, const void *key, const void *value,
+        bool *inserted);
+
 CSTL_LIB void rmap_erase(rmap_t *hmap, const void *key);
 
 CSTL_LIB void *rmap_get(const rmap_t *hmap, const void *key);
 
+// 使用和key类型不同的probe来查找，probe_cmp(probe, key)的顺序必须和创建rmap时指定的比较函数一致，
+// 比如以str_t*为key的rmap可以使用str_slice_t和str_slice_ptr_cmp来查找，不需要分配临时的str_t
+CSTL_LIB void *rmap_get_with(const rmap_t *rmap, const void *probe, cmp_func_t probe_cmp);
+
 CSTL_LIB bool rmap_has_key(const rmap_t *hmap, const void *key);
 
 CSTL_LIB void rmap_set(rmap_t *rmap, const void *key, const void *new_value);
 CSTL_LIB void rmap_clear(rmap_t *rmap);
 CSTL_LIB size_t rmap_size(const rmap_t *hmap);
 
+// 按照key从小到大的顺序遍历所有的元素
 CSTL_LIB void rmap_for_each(rmap_t* rmap, RMAP_FOR_EACH for_each_func, void *user_data);
 
 CSTL_LIB bool rmap_empty(const rmap_t *rmap);
 
+// 下面的函数复杂度都是O(log n)
+
+// 返回rmap中小于key的元素的数目(即key按照顺序排列的位置)
+CSTL_LIB size_t rmap_rank(const rmap_t *rmap, const void *key);
+
+// 返回按照key从小到大排序后第k个(从0开始)元素的key, 如果k越界返回NULL，
+// 如果value不为NULL，则*value会被设置为对应值的地址
+CSTL_LIB const void *rmap_select(const rmap_t *rmap, size_t k, void **value);
+
+// 返回key位于[lo, hi]之间的元素的数目
+CSTL_LIB size_t rmap_count_range(const rmap_t *rmap, const void *lo, const void *hi);
+
 #endif //INCLUDE/RMAP_H_H
@@ -19,6 +19,26 @@
 struct CSTLString; //!< 表示的是本地平台字符串类型
 typedef struct CSTLString str_t; //!< CSTLString的一个别名
 
+/*!
+ * \brief 一个不拥有内存的字符串片段，用来在以str_t*为key的容器中查找，而不用分配临时的str_t
+ */
+typedef struct {
+    const char *data;   //!< 片段的起始地址，不要求以'\0'结尾
+    size_t len;         //!< 片段的字节数目
+} str_slice_t;
+
+/*!
+ *  \brief str_slice 构造一个字符串片段
+ *  \param [in] data 片段的起始地址
+ *  \param [in] len 片段的字节数目
+ *  \retval 返回新的片段，它只是引用data, 不会复制内容
+ */
+static inline str_slice_t str_slice(const char *data, size_t len)
+{
+    str_slice_t slice = { data, len };
+    return slice;
+}
+
 // 工厂方法(内部支持utf-8字符集)
 
 /*!
@@ -286,6 +306,36 @@ CSTL_LIB unsigned int    str_hash_code(str_t *str);
  */
 CSTL_LIB unsigned int    str_ptr_hash_code(str_t **str);
 
+/*!
+ *  \brief str_slice_hash_code 计算字符串片段的hash值
+ *  \param [in] slice 字符串片段
+ *  \retval 返回的hash值和内容相同的str_t使用str_hash_code计算出来的值相同，
+ *  所以可以作为hmap_get_with的hash函数来查找以str_t*为key的hmap
+ *  \note slice不能为NULL，否则会断言失败
+ */
+CSTL_LIB unsigned int    str_slice_hash_code(const str_slice_t *slice);
+
+/*!
+ *  \brief str_ptr_cmp 按照字节比较两个字符串，可以作为以str_t*为key的rmap或者hmap的比较函数
+ *  \param [in] lhv str_t**类型
+ *  \param [in] rhv str_t**类型
+ *  \retval =0 表示*lhv=*rhv，<0表示*lhv < *rhv, >0表示*lhv > *rhv
+ *  \note lhv, rhv, *lhv, *rhv不能为NULL，否则会断言失败
+ */
+CSTL_LIB int    str_ptr_cmp(str_t **lhv, str_t **rhv);
+
+/*!
+ *  \brief str_slice_ptr_cmp 比较字符串片段和str_t**, 顺序和str_ptr_cmp一致
+ *  
+ *  用来作为rmap_get_with, hmap_get_with的比较函数，使用片段直接查找以str_t*为key的容器
+ *  
+ *  \param [in] slice 字符串片段
+ *  \param [in] str str_t**类型
+ *  \retval =0 表示内容相同，<0表示slice < *str, >0表示slice > *str
+ *  \note slice, str, *str不能为NULL，否则会断言失败
+ */
+CSTL_LIB int    str_slice_ptr_cmp(const str_slice_t *slice, str_t **str);
+
 /*!
  *  \brief str_assign 赋值函数
  *  
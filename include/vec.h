@@ -33,6 +33,9 @@ typedef struct {
     int unit_size;                  //!< 单个元素的内存尺寸
     int capacity;                   //!< 当前容器的内存最多可以存储元素的数目
     destroy_func_t destroy_func;    //!< 当元素销毁时候，调用的函数
+    float growth_factor;            //!< 扩容时候容量增长的倍数，默认是2
+    void *inline_beg;               //!< 内置存储的地址，没有内置存储时候是NULL
+    int inline_capacity;            //!< 内置存储最多可以存储元素的数目
 } VEC, vec_t;
 
 /*!
@@ -46,6 +49,36 @@ typedef struct {
 typedef void (*VEC_FOREACH_FUNC)(void *value, void *user_data);
 typedef VEC_FOREACH_FUNC vec_foreach_func_t; //!< VEC_FOREACH_FUNC别名，主要用来统一的类型命名
 
+/*!
+ *  \brief vec_parallel_reduce的映射函数，将一个元素累积到部分结果中
+ *
+ *  \param [in,out] acc 部分结果的地址，初始值是identity的副本
+ *  \param [in] value vec_t容器中某个元素的地址
+ *  \param [in,out] user_data 用户传入过来的数据
+ */
+typedef void (*VEC_MAP_FUNC)(void *acc, const void *value, void *user_data);
+typedef VEC_MAP_FUNC vec_map_func_t; //!< VEC_MAP_FUNC别名
+
+/*!
+ *  \brief vec_parallel_reduce的归约函数，将部分结果other合并到acc中
+ *
+ *  合并必须满足结合律，也就是(a, b)合并之后再和c合并，与a和(b, c)合并的结果相同，但是不需要满足交换律。
+ *  \param [in,out] acc 合并的结果
+ *  \param [in] other 另一个部分结果
+ *  \param [in,out] user_data 用户传入过来的数据
+ */
+typedef void (*VEC_REDUCE_FUNC)(void *acc, const void *other, void *user_data);
+typedef VEC_REDUCE_FUNC vec_reduce_func_t; //!< VEC_REDUCE_FUNC别名
+
+/*!
+ *  \brief vec_remove_if的谓词函数参数
+ *  \param [in] value vec_t容器中某个元素的地址
+ *  \param [in,out] user_data 用户传入过来的数据
+ *  \retval 返回true表示这个元素需要被移除
+ */
+typedef bool (*VEC_PRED_FUNC)(const void *value, void *user_data);
+typedef VEC_PRED_FUNC vec_pred_func_t; //!< VEC_PRED_FUNC别名，主要用来统一的类型命名
+
 /*!
  * \brief vec_new 用来构造一个带有默认容量的vec_t, 默认容量是10。
  * \param [in] unit_size 单个元素的尺寸（即单个元素锁占用的内存大小）, 如果你存放的元素类型是int，那么这个值就应该是
@@ -69,6 +102,64 @@ CSTL_LIB VEC *vec_new(int unit_size, destroy_func_t destroy);
  */
 CSTL_LIB VEC *vec_new_with_capacity(int unit_size, destroy_func_t destroy, int capacity);
 
+/*!
+ * \brief 构造一个带有内置存储的vec_t
+ * 
+ * vec_t结构体和inline_capacity个元素的存储只需要一次内存分配，元素数目不超过inline_capacity时候不会再分配内存，
+ * 超过之后才会将元素搬移到堆上。适合大量元素数目很少的容器。
+ * 
+ * \param [in] unit_size 单个元素的尺寸
+ * \param [in] destroy 销毁元素时候调用的函数
+ * \param [in] inline_capacity 内置存储可以存放的元素数目，必须大于0
+ * \retval 新的vec_t容器实例，和其他vec_t一样使用，不再使用时候调用vec_free
+ */
+CSTL_LIB VEC *vec_new_small(int unit_size, destroy_func_t destroy, int inline_capacity);
+
+/*!
+ * \brief 在调用者提供的vec_t和缓冲区上初始化一个容器，不会分配任何内存
+ * 
+ * 一般不直接使用，而是通过DEFINE_SMALL_VEC定义的类型来使用，buffer作为内置存储，
+ * 元素数目超过capacity时候才会分配堆上的内存。
+ * 
+ * \param [out] vec 要初始化的vec_t
+ * \param [in] unit_size 单个元素的尺寸
+ * \param [in] destroy 销毁元素时候调用的函数
+ * \param [in] buffer 内置存储的地址，生命周期不能短于vec
+ * \param [in] capacity buffer可以存放的元素数目，必须大于0
+ * \retval none.
+ * \note 不再使用时候调用vec_deinit，而不是vec_free
+ */
+CSTL_LIB void vec_init_with_buffer(VEC *vec, int unit_size, destroy_func_t destroy, void *buffer, int capacity);
+
+/*!
+ * \brief 销毁vec_init_with_buffer初始化的容器中的元素，并且释放掉堆上的存储，但是不释放vec本身
+ * \param [in,out] vec vec_t实例
+ * \retval none.
+ * \note vec不能为NULL，否则会断言失败
+ */
+CSTL_LIB void vec_deinit(VEC *vec);
+
+/*!
+ * \brief 使用一块已经存在的内存新建vec_t实例，不会复制元素，之后这块内存由vec管理
+ * \param [in] unit_size 单个元素的内存尺寸
+ * \param [in] destroy 元素的销毁函数，可以为NULL
+ * \param [in] buffer 保存元素的内存，必须是使用cstl_malloc(release版本下就是malloc)分配的，调用者之后不能再释放它
+ * \param [in] len 内存中已经存在的元素的数目
+ * \param [in] capacity 内存最多可以存放的元素数目，不能小于len
+ * \retval 新的vec实例，不再使用的时候调用vec_free，会同时释放buffer
+ */
+CSTL_LIB VEC *vec_new_from_buffer(int unit_size, destroy_func_t destroy, void *buffer, size_t len, size_t capacity);
+
+/*!
+ * \brief 取走vec内部保存元素的内存，元素和内存的所有权都转移给调用者，vec变成空的容器，仍然可以继续使用
+ * \param [in,out] vec vec_t实例
+ * \param [out] len 如果不为NULL，保存元素的数目
+ * \retval 保存元素的内存，调用者不再使用的时候需要使用cstl_free释放(不会调用元素的销毁函数)
+ * \note 元素保存在内置存储中的时候，内置存储不能交给调用者，此时会复制到新分配的内存中，
+ * 其他情况下不会复制元素。vec为空的时候返回的内存也可以安全地释放
+ */
+CSTL_LIB void *vec_release(VEC *vec, size_t *len);
+
 /*!
  * \brief 销毁vec_t实例内存锁占用的所有资源
  * 
@@ -93,6 +184,38 @@ CSTL_LIB void vec_free(VEC *vec);
  */
 CSTL_LIB size_t vec_capacity(const VEC *vec);
 
+/*!
+ * \brief 保证vec_t容器的容量至少是capacity，已经足够的话什么都不做
+ * 
+ * 在知道将要存放多少元素的时候，预先调用此函数可以避免多次扩容。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] capacity 需要的最小容量(元素的数目)
+ * \retval none.
+ * \note vec 绝对不能为空，否则内部会断言失败的
+ */
+CSTL_LIB void vec_reserve(VEC *vec, size_t capacity);
+
+/*!
+ * \brief 释放掉多余的容量，使容量等于当前元素的数目
+ * \param [in,out] vec vec_t实例
+ * \retval none.
+ * \note vec 绝对不能为空，否则内部会断言失败的
+ */
+CSTL_LIB void vec_shrink_to_fit(VEC *vec);
+
+/*!
+ * \brief 设置扩容时候容量增长的倍数
+ * 
+ * 需要扩容时，新的容量是max(当前容量 * factor, 需要的元素数目)。倍数越大扩容次数越少，但是浪费的内存越多。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] factor 增长的倍数，必须大于1，默认是2
+ * \retval none.
+ * \note vec 绝对不能为空，factor必须大于1，否则内部会断言失败的
+ */
+CSTL_LIB void vec_set_growth_factor(VEC *vec, float factor);
+
 /*!
  * \brief 检测vec_t容器是否为空（就是内部使用有元素）
  * \param [in] vec vec_t实例
@@ -109,6 +232,28 @@ CSTL_LIB bool vec_empty(const VEC *vec);
  */
 CSTL_LIB size_t vec_size(const VEC *vec);
 
+/*!
+ * \brief 获取vec_t容器第一个元素的地址，所有的元素在这块内存中连续存放
+ *
+ * 和vec_get、vec_size不同，vec_data和vec_len定义在头文件中，没有断言和越界检查，可以内联到调用者的循环中。
+ * 插入、扩容等会重新分配内存的操作之后，之前返回的地址不再有效。
+ *
+ * \param [in] vec vec_t实例
+ * \retval 第一个元素的地址，容器为空的时候可能是NULL
+ * \note vec 不能为空(NULL)，这里不会检查
+ */
+static inline void *vec_data(const VEC *vec) {
+    return vec->beg;
+}
+
+/*!
+ * \brief 和vec_size相同，但是定义在头文件中，没有断言
+ * \note vec 不能为空(NULL)，这里不会检查
+ */
+static inline size_t vec_len(const VEC *vec) {
+    return (size_t)vec->len;
+}
+
 /*!
  * \brief 重新改变vec_t容器元素的数目
  * 
@@ -259,6 +404,30 @@ CSTL_LIB void vec_extend_front(VEC *vec, const VEC *insert_vec);
  */
 CSTL_LIB void vec_extend_back(VEC *vec, const VEC *insert_vec);
 
+/*!
+ * \brief 在vec容器的index位置上插入连续的count个元素
+ * 
+ * 最多只会扩容一次，原来的元素使用一次memmove整体后移，新的元素使用一次memcpy复制进来。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] index 插入的位置，如果大于等于vec_size(vec)则插入到尾部
+ * \param [in] elems 要插入的元素数组的首地址，可以指向vec自身的元素
+ * \param [in] count 要插入的元素数目
+ * \retval none.
+ * \note vec不能为NULL，count不为0时候elems不能为NULL，否则会断言失败
+ */
+CSTL_LIB void vec_insert_array(VEC *vec, size_t index, const void *elems, size_t count);
+
+/*!
+ * \brief 在vec容器的尾部追加连续的count个元素，等同于vec_insert_array(vec, vec_size(vec), elems, count)
+ * \param [in,out] vec vec_t实例
+ * \param [in] elems 要追加的元素数组的首地址
+ * \param [in] count 要追加的元素数目
+ * \retval none.
+ * \note vec不能为NULL，count不为0时候elems不能为NULL，否则会断言失败
+ */
+CSTL_LIB void vec_append_array(VEC *vec, const void *elems, size_t count);
+
 
 //  访问/修改
 
@@ -348,7 +517,8 @@ CSTL_LIB void vec_remove(VEC *vec, const void *value, cmp_func_t compare); //移
 /*!
  * \brief 移除vec容器中所有和value等值的元素。
  * 
- * 如果值找到的话，并且destroy_func_t设置的话，则会将找到的元素的地址作为参数调用此函数
+ * 如果值找到的话，并且destroy_func_t设置的话，则会将找到的元素的地址作为参数调用此函数。
+ * 内部使用vec_remove_if，时间复杂度是O(n)。
  * 
  * \param [in,out] vec vec_t实例
  * \param [in] value 要移除的值
@@ -370,6 +540,45 @@ CSTL_LIB void vec_remove_all(VEC *vec, const void *value, cmp_func_t compare);
  */
 CSTL_LIB void vec_erase(VEC *vec, size_t index);
 
+/*!
+ * \brief 移除vec容器中索引位于[from, to)之间的元素
+ * 
+ * 如果destroy_func_t设置的话，会以每个被移除的元素的地址为参数调用此函数，后面的元素只需要一次memmove。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] from 第一个要移除的元素的索引
+ * \param [in] to 最后一个要移除的元素的下一个索引，超过vec_size(vec)时候按照vec_size(vec)处理
+ * \retval none.
+ * \note vec 不能为NULL，否则会断言失败，from >= to时候什么都不做
+ */
+CSTL_LIB void vec_erase_range(VEC *vec, size_t from, size_t to);
+
+/*!
+ * \brief 移除vec容器中index位置上的元素，使用最后一个元素来填补空位，时间复杂度是O(1)
+ * 
+ * 不会保持元素之间的相对顺序。如果destroy_func_t设置的话，会以被移除的元素的地址为参数调用此函数。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] index 要移除的元素的索引，无效的索引什么都不做
+ * \retval none.
+ * \note vec 不能为NULL，否则会断言失败
+ */
+CSTL_LIB void vec_swap_remove(VEC *vec, size_t index);
+
+/*!
+ * \brief 移除vec容器中所有使(*pred)(elem, user_data)返回true的元素
+ * 
+ * 只遍历一次，剩下的元素保持原来的相对顺序整体前移，时间复杂度是O(n)。
+ * 如果destroy_func_t设置的话，会以每个被移除的元素的地址为参数调用此函数。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] pred 谓词函数
+ * \param [in,out] user_data 传递给pred的额外参数
+ * \retval 被移除的元素数目
+ * \note vec, pred不能为NULL, 否则会断言失败。
+ */
+CSTL_LIB size_t vec_remove_if(VEC *vec, vec_pred_func_t pred, void *user_data);
+
 /*!
  * \brief 移除vec容器中所有的元素
  * 
@@ -381,10 +590,26 @@ CSTL_LIB void vec_erase(VEC *vec, size_t index);
  */
 CSTL_LIB void vec_clear(VEC *vec); //移除内部所有元素
 
+/*!
+ * \brief 移除vec容器中所有的元素，但是保留已经分配的内存
+ * 
+ * 和vec_clear一样会对每个元素调用destroy_func_t，不同的是容量保持不变，
+ * 适合反复清空、填充的临时容器，之后的插入不需要重新分配内存。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \retval none.
+ * \note vec不能为NULL，否则会断言失败
+ */
+CSTL_LIB void vec_clear_keep_capacity(VEC *vec);
+
 // 查找
 
 /*!
  * \brief 查找vec容器中第一个和val等值的元素
+ * 
+ * compare是CSTL_NUM_CMP_FUNC(int)或者CSTL_NUM_CMP_FUNC(long)时候，不会调用比较函数，而是使用vec_num.h中的
+ * 向量化实现(int_vec_index_of, long_vec_index_of)。
+ * 
  * \param [in] vec vec_t实例
  * \param [in] val 要查找的值
  * \param [in] compare 比较函数, 如果(*compare)(&elem, value) == 0，则说明相等，否则说明不相等
@@ -404,10 +629,92 @@ CSTL_LIB void *vec_find(VEC *vec, const void *val, cmp_func_t compare);
  */
 CSTL_LIB void *vec_bin_find(VEC *vec, const void *val, cmp_func_t compare);
 
-// 排序（使用快速排序算法）
+// 有序vec上的操作，下面的函数都要求vec内部的元素已经按照compare排好序了
+
+/*!
+ * \brief 返回有序vec中第一个不小于val的元素的索引
+ * \param [in] vec vec_t实例
+ * \param [in] val 要查找的值
+ * \param [in] compare 比较函数，调用方式是(*compare)(elem, val)
+ * \retval 第一个满足(*compare)(elem, val) >= 0的元素的索引，如果不存在，返回vec_size(vec)
+ * \note vec, compare不能为NULL，否则会断言失败
+ */
+CSTL_LIB size_t vec_lower_bound(const VEC *vec, const void *val, cmp_func_t compare);
 
 /*!
- * \brief 使用快速排序算法来排序vec内部所有的元素
+ * \brief 返回有序vec中第一个大于val的元素的索引
+ * \param [in] vec vec_t实例
+ * \param [in] val 要查找的值
+ * \param [in] compare 比较函数，调用方式是(*compare)(elem, val)
+ * \retval 第一个满足(*compare)(elem, val) > 0的元素的索引，如果不存在，返回vec_size(vec)
+ * \note vec, compare不能为NULL，否则会断言失败。[lower_bound, upper_bound)就是所有和val相等的元素
+ */
+CSTL_LIB size_t vec_upper_bound(const VEC *vec, const void *val, cmp_func_t compare);
+
+/*!
+ * \brief 移除有序vec中连续的重复元素，每组相等的元素只保留第一个
+ * 
+ * 只遍历一次，时间复杂度是O(n)。如果destroy_func_t设置的话，会以每个被移除的元素的地址为参数调用此函数。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] compare 比较函数
+ * \retval 被移除的元素数目
+ * \note vec, compare不能为NULL，否则会断言失败
+ */
+CSTL_LIB size_t vec_unique(VEC *vec, cmp_func_t compare);
+
+/*!
+ * \brief 将两个有序的vec归并，结果追加到dst的尾部
+ * 
+ * 归并是稳定的，相等的元素a中的在前。dst最多扩容一次，时间复杂度是O(na + nb)。
+ * 元素是按照字节复制的，所以如果元素拥有额外的资源，要注意不要让多个vec同时销毁它。
+ * 
+ * \param [in,out] dst 保存结果的vec_t实例，不能和a, b是同一个
+ * \param [in] a 第一个有序的vec_t实例
+ * \param [in] b 第二个有序的vec_t实例
+ * \param [in] compare 比较函数
+ * \retval none.
+ * \note 所有参数都不能为NULL, 三个vec的元素尺寸必须相同，否则会断言失败
+ */
+CSTL_LIB void vec_merge_sorted(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare);
+
+/*!
+ * \brief 计算两个有序vec的并集，结果追加到dst的尾部
+ * 
+ * 和c++中的std::set_union一样，如果某个值在a中出现m次，在b中出现n次，结果中会出现max(m, n)次，
+ * 相等的元素优先使用a中的。
+ * 
+ * \note 参数的要求和vec_merge_sorted相同
+ */
+CSTL_LIB void vec_set_union(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare);
+
+/*!
+ * \brief 计算两个有序vec的交集，结果追加到dst的尾部
+ * 
+ * 如果某个值在a中出现m次，在b中出现n次，结果中会出现min(m, n)次，元素都来自a。
+ * 
+ * \note 参数的要求和vec_merge_sorted相同
+ */
+CSTL_LIB void vec_set_intersection(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare);
+
+/*!
+ * \brief 计算两个有序vec的差集(在a中但不在b中的元素)，结果追加到dst的尾部
+ * 
+ * 如果某个值在a中出现m次，在b中出现n次，结果中会出现max(m - n, 0)次。
+ * 
+ * \note 参数的要求和vec_merge_sorted相同
+ */
+CSTL_LIB void vec_set_difference(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare);
+
+// 排序（使用pattern-defeating快速排序算法）
+
+/*!
+ * \brief 排序vec内部所有的元素
+ * 
+ * 内部使用的是pattern-defeating快速排序(pdqsort)：使用三数取中选择枢轴，小区间使用插入排序，
+ * 划分极不平衡时退化为堆排序，所以最坏的时间复杂度是O(n log n)，对于有序、逆序、近似有序的输入
+ * 接近O(n)，递归深度最多是O(log n)。这个排序是不稳定的。
+ * 
  * \param [in,out] vec vec_t实例
  * \param [in] compare 比较函数, 如果(*compare)(&elem1, &elem2) == 0，则说明相等，否则说明不相等
  * \retval none.
@@ -415,6 +722,134 @@ CSTL_LIB void *vec_bin_find(VEC *vec, const void *val, cmp_func_t compare);
  */
 CSTL_LIB void vec_sort(VEC *vec, cmp_func_t compare);
 
+/*!
+ * \brief 稳定地排序vec内部所有的元素，相等的元素保持原来的相对顺序
+ * 
+ * 内部使用的是timsort风格的自适应归并排序：利用输入中已经存在的有序区间(降序区间会被翻转)，
+ * 短的区间使用二分插入排序扩展，然后平衡地归并。最坏的时间复杂度是O(n log n)，对于有序或者由少量
+ * 有序区间组成的输入接近O(n)。需要最多n/2个元素的额外内存，在一次排序过程中复用。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] compare 比较函数
+ * \retval none.
+ * \note vec, compare都不能为NULL，否则断言失败。
+ */
+CSTL_LIB void vec_stable_sort(VEC *vec, cmp_func_t compare);
+
+/*!
+ * \brief 使用多个线程排序vec内部所有的元素
+ * 
+ * 先将元素平均分成nthreads块，每个线程使用和vec_sort相同的算法排序自己的块，然后逐轮并行地两两归并，
+ * 每一轮的归并都会按照输出位置切分给所有的线程。需要额外n个元素的内存。
+ * 排序结果和vec_sort一样是有序的，但是是不稳定的。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] compare 比较函数，会被多个线程同时调用，所以必须是线程安全的
+ * \param [in] nthreads 使用的线程数目(包括调用线程)，0表示使用cpu核心的数目。元素太少时候使用的线程会少于nthreads，
+ * 只有一个线程时候等同于vec_sort
+ * \retval none.
+ * \note vec, compare都不能为NULL，nthreads不能小于0，否则断言失败。
+ */
+CSTL_LIB void vec_sort_parallel(VEC *vec, cmp_func_t compare, int nthreads);
+
+/*!
+ * \brief 重新排列vec，使得索引为k的元素就是排序之后这个位置上的元素，并且它前面的元素都不大于它，后面的元素都不小于它
+ * 
+ * 用来求中位数、百分位数等只需要一个位置上的元素的场合。使用和vec_sort相同的枢轴选择和划分，
+ * 但是每次只处理包含k的一侧(introselect)，平均时间复杂度是O(n)，最坏情况是O(n log n)。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] k 要选择的元素的索引，大于等于vec_size(vec)的时候什么也不做
+ * \param [in] compare 比较函数
+ * \retval none.
+ * \note vec, compare都不能为NULL，否则断言失败。
+ */
+CSTL_LIB void vec_nth_element(VEC *vec, size_t k, cmp_func_t compare);
+
+/*!
+ * \brief 将最小的k个元素按照顺序放到vec的前k个位置上，其余元素的顺序是不确定的
+ * 
+ * 先使用vec_nth_element选出前k个元素，再对它们排序，时间复杂度是O(n + k log k)。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] k 需要排序的元素数目，大于等于vec_size(vec)的时候等同于vec_sort
+ * \param [in] compare 比较函数
+ * \retval none.
+ * \note vec, compare都不能为NULL，否则断言失败。
+ */
+CSTL_LIB void vec_partial_sort(VEC *vec, size_t k, cmp_func_t compare);
+
+/*!
+ * \brief 将src中最小的k个元素按照升序添加到dst的尾部，src不会被修改
+ * 
+ * 使用容量为k的最大堆扫描一遍src，时间复杂度是O(n log k)，只需要k个元素的额外内存。
+ * 如果需要最大的k个元素，传入相反的比较函数即可。
+ * 
+ * \param [in,out] dst 保存结果的vec，不能和src是同一个vec
+ * \param [in] src 输入的vec
+ * \param [in] k 需要的元素数目，大于vec_size(src)的时候添加所有的元素
+ * \param [in] compare 比较函数
+ * \retval none.
+ * \note dst, src, compare都不能为NULL，dst和src的元素尺寸必须相同，否则断言失败。
+ */
+CSTL_LIB void vec_top_k(VEC *dst, const VEC *src, size_t k, cmp_func_t compare);
+
+/*!
+ * \brief 计算排序vec之后元素的原始索引，vec本身不会被修改
+ * 
+ * 排序之后的第i个元素是vec中索引为indices[i]的元素。排序是稳定的，相等的元素按照原来的索引排列。
+ * 
+ * \param [in] vec vec_t实例
+ * \param [in] compare 比较函数
+ * \param [out] indices 保存结果，至少要有vec_size(vec)个元素的空间
+ * \retval none.
+ * \note vec, compare, indices都不能为NULL，否则断言失败。
+ */
+CSTL_LIB void vec_argsort(const VEC *vec, cmp_func_t compare, size_t *indices);
+
+/*!
+ * \brief 按照indices重新排列元素，重新排列之后的第i个元素是原来索引为indices[i]的元素
+ * \param [in,out] vec vec_t实例
+ * \param [in] indices 0到vec_size(vec)-1的一个排列，比如vec_argsort的结果
+ * \retval none.
+ * \note vec, indices都不能为NULL，否则断言失败。
+ */
+CSTL_LIB void vec_permute(VEC *vec, const size_t *indices);
+
+/*!
+ * \brief 按照key的顺序同时重新排列多个元素数目相同的vec，用来排序按列存储的数据
+ * \param [in,out] columns 需要重新排列的vec，可以包含key本身
+ * \param [in] count columns中vec的数目
+ * \param [in] key 决定顺序的vec
+ * \param [in] compare key的比较函数
+ * \retval none.
+ * \note 排序是稳定的。所有的vec的元素数目必须和key相同，否则断言失败。
+ */
+CSTL_LIB void vec_sort_columns(VEC **columns, int count, const VEC *key, cmp_func_t compare);
+
+/*!
+ * \brief vec_radix_sort中元素的解释方式
+ */
+typedef enum {
+    VEC_RADIX_UNSIGNED,     //!< 无符号整数
+    VEC_RADIX_SIGNED,       //!< 有符号整数(补码)
+    VEC_RADIX_FLOAT,        //!< IEEE 754浮点数(float或者double)
+} vec_radix_key_t;
+
+/*!
+ * \brief 使用LSD基数排序来排序数值类型vec内部所有的元素
+ * 
+ * 不会调用比较函数，而是将元素的二进制表示转换为可以按照无符号整数比较的形式(有符号数翻转符号位，
+ * 浮点数翻转符号位或者全部位)，然后按照字节统计直方图，逐个字节进行稳定的分配。所有字节都相同的那一轮
+ * 会被跳过，时间复杂度是O(n * unit_size)，需要额外O(n)的内存。
+ * 
+ * \param [in,out] vec vec_t实例, 元素的尺寸必须是1, 2, 4, 8
+ * \param [in] kind 元素的解释方式, VEC_RADIX_FLOAT要求元素的尺寸必须是4或者8
+ * \retval none.
+ * \note vec不能为NULL，否则断言失败。浮点数的-0.0会排在0.0前面，NaN按照其二进制表示排在两端。
+ */
+CSTL_LIB void vec_radix_sort(VEC *vec, vec_radix_key_t kind);
+
 /*!
  * \brief 交换vec容器中两个索引位置上的值
  * \param [in,out] vec vec_t实例
@@ -443,6 +878,112 @@ CSTL_LIB void vec_swap(VEC *vec, size_t idx1, size_t idx2);
  */
 CSTL_LIB void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *user_data);
 
+/*!
+ * \brief 使用多个线程遍历vec容器中的所有元素
+ * 
+ * 元素被分成若干个连续的块，每个线程开始的时候分到相邻的一段块，处理完自己的块之后从其他线程剩下的块中偷走一半，
+ * 所以每个元素的耗时不均匀的时候，所有线程也能同时完成。元素被访问的顺序是不确定的。
+ * 
+ * \param [in,out] vec vec_t实例
+ * \param [in] vec_foreach_func 遍历回调函数，会被多个线程同时调用，所以必须是线程安全的
+ * \param [in,out] user_data 额外参数，所有线程共享
+ * \param [in] nthreads 使用的线程数目(包括调用线程)，0表示使用cpu核心的数目。元素太少时候使用的线程会少于nthreads，
+ * 只有一个线程时候等同于vec_foreach
+ * \retval none.
+ * \note vec和vec_foreach_func都不能为NULL，nthreads不能小于0，否则会断言失败。
+ */
+CSTL_LIB void vec_parallel_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *user_data, int nthreads);
+
+/*!
+ * \brief 使用多个线程将vec容器中的所有元素归约为一个结果
+ * 
+ * 和vec_parallel_foreach一样分块和分配给线程，每个块有自己的部分结果，初始值是identity，
+ * 块中的元素依次使用map_func累积到部分结果中。所有线程结束之后，调用线程按照块的顺序使用reduce_func合并部分结果，
+ * 所以reduce_func只需要满足结合律。分块只取决于元素数目和线程数目，相同的参数得到的结果(包括浮点数的舍入)是相同的。
+ * 
+ * 比如求和：
+ * ```cpp
+ * static void add(void *acc, const void *value, void *user_data) { *(double *)acc += *(const double *)value; }
+ * double zero = 0, sum;
+ * vec_parallel_reduce(vec, add, add, &zero, &sum, sizeof(double), NULL, 0);
+ * ```
+ * 
+ * \param [in] vec vec_t实例
+ * \param [in] map_func 映射函数，会被多个线程同时调用，所以必须是线程安全的
+ * \param [in] reduce_func 归约函数，只在调用线程中调用
+ * \param [in] identity 部分结果的初始值，和任何结果合并都不会改变那个结果，比如求和的0
+ * \param [out] result 保存最终的结果，可以和identity相同
+ * \param [in] result_size 结果的内存尺寸
+ * \param [in,out] user_data 传给map_func和reduce_func的额外参数
+ * \param [in] nthreads 使用的线程数目(包括调用线程)，0表示使用cpu核心的数目
+ * \retval none.
+ * \note vec, map_func, reduce_func, identity, result都不能为NULL，result_size必须大于0，nthreads不能小于0，
+ * 否则会断言失败。
+ */
+CSTL_LIB void vec_parallel_reduce(const VEC *vec, vec_map_func_t map_func, vec_reduce_func_t reduce_func,
+        const void *identity, void *result, size_t result_size, void *user_data, int nthreads);
+
+// 视图
+
+/*!
+ * \brief 指向一段连续元素的视图，不拥有这些元素
+ * 
+ * 视图只是记录元素的地址、数目和尺寸，创建和切片都不会复制元素，也不会分配内存，可以直接按值传递。
+ * 它可以指向vec的全部或者一部分元素，也可以指向其他地方(比如网络缓冲区、mmap的文件)的数组。
+ * 视图引用的内存必须在使用视图期间一直有效，vec扩容之后原来的视图就失效了。
+ */
+typedef struct {
+    void *beg;          //!< 第一个元素的地址
+    size_t len;         //!< 元素的数目
+    int unit_size;      //!< 单个元素的内存尺寸
+} vec_view_t, VEC_VIEW;
+
+/*!
+ * \brief 返回vec中所有元素的视图
+ */
+CSTL_LIB vec_view_t vec_view(VEC *vec);
+
+/*!
+ * \brief 返回vec中索引位于[from, to)的元素的视图
+ * \note 要求from <= to <= vec_size(vec)，否则断言失败
+ */
+CSTL_LIB vec_view_t vec_slice(VEC *vec, size_t from, size_t to);
+
+/*!
+ * \brief 返回数组data的视图
+ * \param [in] data 第一个元素的地址，len为0的时候可以为NULL
+ * \param [in] len 元素的数目
+ * \param [in] unit_size 单个元素的内存尺寸
+ */
+CSTL_LIB vec_view_t vec_view_of(void *data, size_t len, int unit_size);
+
+/*!
+ * \brief 返回view中索引位于[from, to)的元素的视图
+ * \note 要求from <= to <= view.len，否则断言失败
+ */
+CSTL_LIB vec_view_t vec_view_slice(vec_view_t view, size_t from, size_t to);
+
+/*!
+ * \brief 获取view中索引为index的元素的地址，index超出范围的时候返回NULL
+ */
+CSTL_LIB void *vec_view_get(vec_view_t view, size_t index);
+
+//// 下面的函数和对应的vec_xxx函数的行为完全相同，只是作用于视图中的元素
+
+CSTL_LIB void vec_view_sort(vec_view_t view, cmp_func_t compare);
+
+CSTL_LIB void vec_view_stable_sort(vec_view_t view, cmp_func_t compare);
+
+CSTL_LIB void vec_view_nth_element(vec_view_t view, size_t k, cmp_func_t compare);
+
+CSTL_LIB void *vec_view_find(vec_view_t view, const void *val, cmp_func_t compare);
+
+CSTL_LIB void *vec_view_bin_find(vec_view_t view, const void *val, cmp_func_t compare);
+
+CSTL_LIB size_t vec_view_lower_bound(vec_view_t view, const void *val, cmp_func_t compare);
+
+CSTL_LIB size_t vec_view_upper_bound(vec_view_t view, const void *val, cmp_func_t compare);
+
 //// 下面定义的宏， 主要忽略类型转换问题
 #define DEFINE_NUM_TYPE_VEC(type) \
     static inline VEC * type##_vec_new() {\
@@ -459,6 +1000,12 @@ CSTL_LIB void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *u
         void *ret = vec_at(vec, index);\
         return (ret == NULL ? (type *)NULL : (type *)ret);\
     }\
+    static inline type * type##_vec_data(VEC *vec) {\
+        return (type *)vec_data(vec);\
+    }\
+    static inline type * type##_vec_get_unchecked(VEC *vec, size_t index) {\
+        return (type *)vec_data(vec) + index;\
+    }\
     static inline type * type##_vec_front(VEC *vec) {\
         void *ret = vec_front(vec);\
         return (ret == NULL ? (type *)NULL : (type *)ret);\
@@ -492,6 +1039,18 @@ CSTL_LIB void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *u
     static inline void type##_vec_sort(VEC *vec) {\
         vec_sort(vec, CSTL_NUM_CMP_FUNC(type)); \
     }\
+    static inline void type##_vec_nth_element(VEC *vec, size_t k) {\
+        vec_nth_element(vec, k, CSTL_NUM_CMP_FUNC(type)); \
+    }\
+    static inline void type##_vec_partial_sort(VEC *vec, size_t k) {\
+        vec_partial_sort(vec, k, CSTL_NUM_CMP_FUNC(type)); \
+    }\
+    static inline void type##_vec_top_k(VEC *dst, const VEC *src, size_t k) {\
+        vec_top_k(dst, src, k, CSTL_NUM_CMP_FUNC(type)); \
+    }\
+    static inline void type##_vec_radix_sort(VEC *vec) {\
+        vec_radix_sort(vec, ((type)-1 < (type)0) ? VEC_RADIX_SIGNED : VEC_RADIX_UNSIGNED); \
+    }\
     static inline void type##_vec_resize(VEC *vec, int new_size, type value) {\
         vec_resize(vec, new_size, &value);\
     }
@@ -511,6 +1070,12 @@ CSTL_LIB void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *u
         void *ret = vec_at(vec, index);\
         return (ret == NULL ? (type *)NULL : (type *)ret);\
     }\
+    static inline type * type##_vec_data(VEC *vec) {\
+        return (type *)vec_data(vec);\
+    }\
+    static inline type * type##_vec_get_unchecked(VEC *vec, size_t index) {\
+        return (type *)vec_data(vec) + index;\
+    }\
     static inline type * type##_vec_front(VEC *vec) {\
         void *ret = vec_front(vec);\
         return (ret == NULL ? (type *)NULL : (type *)ret);\
@@ -544,6 +1109,18 @@ CSTL_LIB void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *u
     static inline void type##_vec_sort(VEC *vec) {\
         vec_sort(vec, CSTL_NUM_CMP_FUNC(type)); \
     }\
+    static inline void type##_vec_nth_element(VEC *vec, size_t k) {\
+        vec_nth_element(vec, k, CSTL_NUM_CMP_FUNC(type)); \
+    }\
+    static inline void type##_vec_partial_sort(VEC *vec, size_t k) {\
+        vec_partial_sort(vec, k, CSTL_NUM_CMP_FUNC(type)); \
+    }\
+    static inline void type##_vec_top_k(VEC *dst, const VEC *src, size_t k) {\
+        vec_top_k(dst, src, k, CSTL_NUM_CMP_FUNC(type)); \
+    }\
+    static inline void type##_vec_radix_sort(VEC *vec) {\
+        vec_radix_sort(vec, VEC_RADIX_FLOAT); \
+    }\
     static inline void type##_vec_resize(VEC *vec, int new_size, type value) {\
         vec_resize(vec, new_size, &value);\
     }
@@ -563,6 +1140,12 @@ CSTL_LIB void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *u
         void *ret = vec_at(vec, index);\
         return (ret == NULL ? (unsigned type *)NULL : (unsigned type *)ret);\
     }\
+    static inline unsigned type * unsigned_##type##_vec_data(VEC *vec) {\
+        return (unsigned type *)vec_data(vec);\
+    }\
+    static inline unsigned type * unsigned_##type##_vec_get_unchecked(VEC *vec, size_t index) {\
+        return (unsigned type *)vec_data(vec) + index;\
+    }\
     static inline unsigned type * unsigned_##type##_vec_front(VEC *vec) {\
         void *ret = vec_front(vec);\
         return (ret == NULL ? (unsigned type *)NULL : (unsigned type *)ret);\
@@ -596,6 +1179,18 @@ CSTL_LIB void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *u
     static inline void unsigned_##type##_vec_sort(VEC *vec) {\
         vec_sort(vec, CSTL_UNSIGNED_CMP_FUNC(type)); \
     }\
+    static inline void unsigned_##type##_vec_nth_element(VEC *vec, size_t k) {\
+        vec_nth_element(vec, k, CSTL_UNSIGNED_CMP_FUNC(type)); \
+    }\
+    static inline void unsigned_##type##_vec_partial_sort(VEC *vec, size_t k) {\
+        vec_partial_sort(vec, k, CSTL_UNSIGNED_CMP_FUNC(type)); \
+    }\
+    static inline void unsigned_##type##_vec_top_k(VEC *dst, const VEC *src, size_t k) {\
+        vec_top_k(dst, src, k, CSTL_UNSIGNED_CMP_FUNC(type)); \
+    }\
+    static inline void unsigned_##type##_vec_radix_sort(VEC *vec) {\
+        vec_radix_sort(vec, VEC_RADIX_UNSIGNED); \
+    }\
     static inline void unsigned_##type##_vec_resize(VEC *vec, int new_size, unsigned type value) {\
         vec_resize(vec, new_size, &value);\
     }
@@ -634,6 +1229,12 @@ DEFINE_UNSIGNED_NUM_TYPE_VEC(long)
         void *ret = vec_at(vec, index);\
         return (ret == NULL ? (type *)NULL : (type *)ret);\
     }\
+    static inline type * type##_vec_data(VEC *vec) {\
+        return (type *)vec_data(vec);\
+    }\
+    static inline type * type##_vec_get_unchecked(VEC *vec, size_t index) {\
+        return (type *)vec_data(vec) + index;\
+    }\
     static inline type * type##_vec_front(VEC *vec) {\
         void *ret = vec_front(vec);\
         return (ret == NULL ? (type *)NULL : (type *)ret);\
@@ -677,8 +1278,97 @@ DEFINE_UNSIGNED_NUM_TYPE_VEC(long)
     static inline void type##_vec_sort(VEC *vec) {\
         vec_sort(vec, &cmp_func); \
     }\
+    static inline void type##_vec_nth_element(VEC *vec, size_t k) {\
+        vec_nth_element(vec, k, &cmp_func); \
+    }\
+    static inline void type##_vec_partial_sort(VEC *vec, size_t k) {\
+        vec_partial_sort(vec, k, &cmp_func); \
+    }\
+    static inline void type##_vec_top_k(VEC *dst, const VEC *src, size_t k) {\
+        vec_top_k(dst, src, k, &cmp_func); \
+    }\
     static inline void type##_vec_sort_func(VEC *vec, cmp_func_t compare) {\
         vec_sort(vec, compare); \
+    }\
+    static inline void type##_vec_stable_sort(VEC *vec) {\
+        vec_stable_sort(vec, &cmp_func); \
+    }\
+    static inline void type##_vec_stable_sort_func(VEC *vec, cmp_func_t compare) {\
+        vec_stable_sort(vec, compare); \
+    }
+
+//// 定义带有N个元素的内置存储的vec类型type##_small_vec_t，它可以直接放在栈上或者嵌入到其他结构体中，
+//// 元素数目不超过N时候不会分配任何内存。
+//// 初始化之后通过type##_small_vec_init返回的VEC*，可以使用所有vec_xxx函数，用完之后调用type##_small_vec_deinit。
+//// 因为vec内部保存了内置存储的地址，所以初始化之后不能按值复制或者移动type##_small_vec_t。
+#define DEFINE_SMALL_VEC(type, N) \
+    typedef struct {\
+        VEC vec;\
+        type inline_data[N];\
+    } type##_small_vec_t;\
+    static inline VEC * type##_small_vec_init(type##_small_vec_t *svec) {\
+        vec_init_with_buffer(&svec->vec, sizeof(type), NULL, svec->inline_data, N);\
+        return &svec->vec;\
+    }\
+    static inline void type##_small_vec_deinit(type##_small_vec_t *svec) {\
+        vec_deinit(&svec->vec);\
+    }
+
+//// 定义按列存储(struct of arrays)的记录容器prefix##_soa_t，每个字段保存在自己的vec中，
+//// 只扫描少数几个字段的时候，不需要把其他字段也读到缓存中。
+//// type   - 记录的结构体类型
+//// fields - 列出字段的宏，对每个字段以X(字段类型, 字段名)的形式调用它的参数，例如：
+////
+////     typedef struct { int id; double price; long qty; } order_t;
+////     #define ORDER_FIELDS(X) X(int, id) X(double, price) X(long, qty)
+////     DEFINE_SOA_VEC(order, order_t, ORDER_FIELDS)
+////
+//// 生成的order_soa_t中每个字段都是一个同名的VEC*成员(比如soa.price)，可以直接使用所有的vec函数，
+//// 比如double_vec_sum(soa.price)。整行的插入、读取和按列排序使用生成的函数，
+//// 不要单独修改某一列的元素数目，get_row和set_row的index必须小于元素数目。
+//// 和type##_small_vec_t一样使用init和deinit管理。
+#define __SOA_COLUMN_MEMBER(ftype, name) VEC *name;
+#define __SOA_COLUMN_PTR(ftype, name) soa->name,
+#define __SOA_COLUMN_INIT(ftype, name) soa->name = vec_new(sizeof(ftype), NULL);
+#define __SOA_COLUMN_DEINIT(ftype, name) vec_free(soa->name);
+#define __SOA_COLUMN_PUSH(ftype, name) vec_push_back(soa->name, &row->name);
+#define __SOA_COLUMN_GET(ftype, name) row->name = ((ftype *)vec_data(soa->name))[index];
+#define __SOA_COLUMN_SET(ftype, name) vec_set(soa->name, index, &row->name);
+#define __SOA_COLUMN_RESERVE(ftype, name) vec_reserve(soa->name, capacity);
+#define __SOA_COLUMN_CLEAR(ftype, name) vec_clear(soa->name);
+
+#define DEFINE_SOA_VEC(prefix, type, fields) \
+    typedef struct {\
+        fields(__SOA_COLUMN_MEMBER)\
+    } prefix##_soa_t;\
+    static inline void prefix##_soa_init(prefix##_soa_t *soa) {\
+        fields(__SOA_COLUMN_INIT)\
+    }\
+    static inline void prefix##_soa_deinit(prefix##_soa_t *soa) {\
+        fields(__SOA_COLUMN_DEINIT)\
+    }\
+    static inline size_t prefix##_soa_size(prefix##_soa_t *soa) {\
+        VEC *columns[] = { fields(__SOA_COLUMN_PTR) };\
+        return vec_size(columns[0]);\
+    }\
+    static inline void prefix##_soa_push_back(prefix##_soa_t *soa, const type *row) {\
+        fields(__SOA_COLUMN_PUSH)\
+    }\
+    static inline void prefix##_soa_get_row(prefix##_soa_t *soa, size_t index, type *row) {\
+        fields(__SOA_COLUMN_GET)\
+    }\
+    static inline void prefix##_soa_set_row(prefix##_soa_t *soa, size_t index, const type *row) {\
+        fields(__SOA_COLUMN_SET)\
+    }\
+    static inline void prefix##_soa_reserve(prefix##_soa_t *soa, size_t capacity) {\
+        fields(__SOA_COLUMN_RESERVE)\
+    }\
+    static inline void prefix##_soa_clear(prefix##_soa_t *soa) {\
+        fields(__SOA_COLUMN_CLEAR)\
+    }\
+    static inline void prefix##_soa_sort_by(prefix##_soa_t *soa, const VEC *column, cmp_func_t compare) {\
+        VEC *columns[] = { fields(__SOA_COLUMN_PTR) };\
+        vec_sort_columns(columns, sizeof(columns) / sizeof(columns[0]), column, compare);\
     }
 
 #undef DEFINE_NUM_TYPE_VEC
@@ -0,0 +1,77 @@
+/*!
+ * \file vec_num.h
+ * \author twoflyliu
+ * \version v0.0.6
+ * \date 2026年10月19日16:05:12
+ * \copyright GNU Public License V3.0
+ * \brief 此文件中声明了针对数值类型vec_t的批量查找、归约和变换函数。
+ *
+ * vec_find这类通用的函数每比较一个元素都要通过函数指针调用一次比较函数，编译器没有办法进行向量化。
+ * 这里的函数直接操作int, long, float, double类型的连续内存：
+ * - 在支持的cpu上(x86下的gcc/clang)运行时检测cpu特性，使用AVX2指令一次处理多个元素
+ * - 其他情况使用分块的标量实现，编译器可以将它自动向量化为基础的SSE2指令
+ *
+ * 定义CSTL_VEC_NUM_NO_SIMD宏可以在编译时禁用手写的SIMD实现。
+ *
+ * 求和与点积使用更宽的类型累加：int和long累加到long long，float和double累加到double，
+ * 因为使用多路累加器，所以浮点数的结果和按顺序逐个相加的结果可能会有舍入误差上的不同。
+ * 原地变换的函数溢出时候的行为和对应类型的C语言运算相同。
+ *
+ * 浮点数使用==进行精确比较，这和CSTL_NUM_CMP_FUNC(float)的近似比较不同。
+ * vec的元素尺寸必须和对应的类型尺寸相同，否则会断言失败。
+ */
+
+#ifndef VEC_NUM_H_H
+#define VEC_NUM_H_H
+
+#include "vec.h"
+
+//// 下面的宏用来为每一种数值类型声明一组相同的函数
+#define DECLARE_NUM_VEC_SEARCH(type) \
+    /*! \brief 返回第一个等于value的元素的索引，不存在的话返回vec_size(vec) */\
+    CSTL_LIB size_t type##_vec_index_of(const VEC *vec, type value);\
+    /*! \brief 返回等于value的元素的数目 */\
+    CSTL_LIB size_t type##_vec_count(const VEC *vec, type value);\
+    /*! \brief 判断vec中是否存在等于value的元素 */\
+    CSTL_LIB bool type##_vec_contains(const VEC *vec, type value);\
+    /*! \brief 获取最小的元素，vec为空时候返回false，否则返回true并且将结果保存到*result中 */\
+    CSTL_LIB bool type##_vec_min(const VEC *vec, type *result);\
+    /*! \brief 获取最大的元素，vec为空时候返回false，否则返回true并且将结果保存到*result中 */\
+    CSTL_LIB bool type##_vec_max(const VEC *vec, type *result);
+
+DECLARE_NUM_VEC_SEARCH(int)
+DECLARE_NUM_VEC_SEARCH(long)
+DECLARE_NUM_VEC_SEARCH(float)
+DECLARE_NUM_VEC_SEARCH(double)
+
+#undef DECLARE_NUM_VEC_SEARCH
+
+#define DECLARE_NUM_VEC_ARITH(type, sum_type) \
+    /*! \brief 返回所有元素的和，vec为空时候返回0 */\
+    CSTL_LIB sum_type type##_vec_sum(const VEC *vec);\
+    /*! \brief 返回a和b的点积，a和b的元素数目必须相同 */\
+    CSTL_LIB sum_type type##_vec_dot(const VEC *a, const VEC *b);\
+    /*! \brief 原地计算前缀和，第i个元素变为原来的第0个元素到第i个元素之和 */\
+    CSTL_LIB void type##_vec_prefix_sum(VEC *vec);\
+    /*! \brief 所有元素都乘以factor */\
+    CSTL_LIB void type##_vec_scale(VEC *vec, type factor);\
+    /*! \brief 所有元素都加上delta */\
+    CSTL_LIB void type##_vec_add_scalar(VEC *vec, type delta);\
+    /*! \brief dst的每个元素都加上src对应位置的元素，dst和src的元素数目必须相同 */\
+    CSTL_LIB void type##_vec_add(VEC *dst, const VEC *src);\
+    /*! \brief 将所有元素限制到[lo, hi]范围之内，要求lo <= hi */\
+    CSTL_LIB void type##_vec_clamp(VEC *vec, type lo, type hi);
+
+DECLARE_NUM_VEC_ARITH(int, long long)
+DECLARE_NUM_VEC_ARITH(long, long long)
+DECLARE_NUM_VEC_ARITH(float, double)
+DECLARE_NUM_VEC_ARITH(double, double)
+
+#undef DECLARE_NUM_VEC_ARITH
+
+/*!
+ * \brief 返回当前使用的实现的名字，"avx2"或者"scalar"，主要用于调试和测试
+ */
+CSTL_LIB const char *vec_num_isa(void);
+
+#endif //VEC_NUM_H_H
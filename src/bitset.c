@@ -0,0 +1,297 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 19:16:08
+*/
+#include <assert.h>
+#include <string.h>
+
+#include "bitset.h"
+#include "leak.h"
+
+// x86下的gcc/clang中计数函数会再以popcnt为目标编译一次，运行时检测cpu是否支持
+#if !defined(CSTL_BITSET_NO_POPCNT) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define BITSET_X86 1
+#else
+#   define BITSET_X86 0
+#endif
+
+#define WORD_COUNT(nbits) (((nbits) + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS)
+#define ALL_ONES (~(uint64_t)0)
+
+// 最后一个字中有效位的掩码
+static inline uint64_t
+__tail_mask(size_t nbits)
+{
+    size_t rest = nbits % BITSET_WORD_BITS;
+    return rest ? ((uint64_t)1 << rest) - 1 : ALL_ONES;
+}
+
+// 将最后一个字中超过nbits的位清0，维持bitset_t的不变式
+static inline void
+__clear_tail(bitset_t *bitset)
+{
+    size_t nwords = WORD_COUNT(bitset->nbits);
+    if (nwords > 0) {
+        bitset->words[nwords - 1] &= __tail_mask(bitset->nbits);
+    }
+}
+
+// 即使没有位也分配一个字，这样words总是有效的
+static inline uint64_t *
+__alloc_words(size_t nwords)
+{
+    return (uint64_t*)cstl_malloc((nwords ? nwords : 1) * sizeof(uint64_t));
+}
+
+// 在没有popcnt指令的编译目标下__builtin_popcountll是一个查表或者位运算的函数调用，
+// 所以同一个循环会再以popcnt为目标编译一次
+#define DEFINE_COUNT_KERNEL(prefix, attr) \
+static attr size_t \
+prefix##_count_words(const uint64_t *words, size_t nwords) \
+{ \
+    size_t count = 0; \
+    for (size_t i = 0; i < nwords; i++) { \
+        count += (size_t)__builtin_popcountll(words[i]); \
+    } \
+    return count; \
+}
+
+DEFINE_COUNT_KERNEL(__scalar, )
+
+#if BITSET_X86
+
+DEFINE_COUNT_KERNEL(__popcnt, __attribute__((target("popcnt"))))
+
+// 第一次调用时检测cpu特性，检测的结果是确定的，所以多个线程同时检测也没有问题
+static bool
+__use_popcnt(void)
+{
+    static int supported = -1;  // -1表示还没有检测
+    int value = __atomic_load_n(&supported, __ATOMIC_RELAXED);
+
+    if (value < 0) {
+        __builtin_cpu_init();
+        value = __builtin_cpu_supports("popcnt") ? 1 : 0;
+        __atomic_store_n(&supported, value, __ATOMIC_RELAXED);
+    }
+    return value != 0;
+}
+
+#define COUNT_WORDS (__use_popcnt() ? __popcnt_count_words : __scalar_count_words)
+
+#else
+
+#define COUNT_WORDS __scalar_count_words
+
+#endif //BITSET_X86
+
+#undef DEFINE_COUNT_KERNEL
+
+bitset_t *bitset_new(size_t nbits)
+{
+    bitset_t *bitset = (bitset_t*)cstl_malloc(sizeof(bitset_t));
+    size_t nwords = WORD_COUNT(nbits);
+
+    bitset->words = __alloc_words(nwords);
+    memset(bitset->words, 0, nwords * sizeof(uint64_t));
+    bitset->nbits = nbits;
+    return bitset;
+}
+
+void bitset_free(bitset_t *bitset)
+{
+    assert(bitset);
+    cstl_free(bitset->words);
+    cstl_free(bitset);
+}
+
+bitset_t *bitset_clone(const bitset_t *bitset)
+{
+    bitset_t *result;
+    size_t nwords;
+
+    assert(bitset);
+
+    nwords = WORD_COUNT(bitset->nbits);
+    result = (bitset_t*)cstl_malloc(sizeof(bitset_t));
+    result->words = __alloc_words(nwords);
+    memcpy(result->words, bitset->words, nwords * sizeof(uint64_t));
+    result->nbits = bitset->nbits;
+    return result;
+}
+
+size_t bitset_size(const bitset_t *bitset)
+{
+    assert(bitset);
+    return bitset->nbits;
+}
+
+void bitset_resize(bitset_t *bitset, size_t nbits)
+{
+    size_t old_nwords, new_nwords;
+
+    assert(bitset);
+
+    old_nwords = WORD_COUNT(bitset->nbits);
+    new_nwords = WORD_COUNT(nbits);
+    if (new_nwords != old_nwords) {
+        bitset->words = (uint64_t*)cstl_realloc(bitset->words,
+                (new_nwords ? new_nwords : 1) * sizeof(uint64_t));
+    }
+    if (new_nwords > old_nwords) {
+        memset(bitset->words + old_nwords, 0, (new_nwords - old_nwords) * sizeof(uint64_t));
+    }
+    // 变小的时候去掉尾部的位，变大的时候原来的尾部本来就是0
+    bitset->nbits = nbits;
+    __clear_tail(bitset);
+}
+
+// 将[from, to)范围内的位和value做运算(置1或者清0)，首尾两个不完整的字使用掩码
+static void
+__bitset_fill_range(bitset_t *bitset, size_t from, size_t to, bool value)
+{
+    size_t first, last;
+    uint64_t first_mask, last_mask;
+
+    assert(bitset && from <= to && to <= bitset->nbits);
+
+    if (from == to) return;
+
+    first = from / BITSET_WORD_BITS;
+    last = (to - 1) / BITSET_WORD_BITS;
+    first_mask = ALL_ONES << (from % BITSET_WORD_BITS);
+    last_mask = __tail_mask(to);
+
+    if (first == last) {
+        first_mask &= last_mask;
+        last_mask = first_mask;
+    }
+
+    if (value) {
+        bitset->words[first] |= first_mask;
+        memset(bitset->words + first + 1, 0xff, (last > first + 1 ? last - first - 1 : 0) * sizeof(uint64_t));
+        bitset->words[last] |= last_mask;
+    } else {
+        bitset->words[first] &= ~first_mask;
+        memset(bitset->words + first + 1, 0, (last > first + 1 ? last - first - 1 : 0) * sizeof(uint64_t));
+        bitset->words[last] &= ~last_mask;
+    }
+}
+
+void bitset_set_range(bitset_t *bitset, size_t from, size_t to)
+{
+    __bitset_fill_range(bitset, from, to, true);
+}
+
+void bitset_reset_range(bitset_t *bitset, size_t from, size_t to)
+{
+    __bitset_fill_range(bitset, from, to, false);
+}
+
+void bitset_set_all(bitset_t *bitset)
+{
+    assert(bitset);
+    memset(bitset->words, 0xff, WORD_COUNT(bitset->nbits) * sizeof(uint64_t));
+    __clear_tail(bitset);
+}
+
+void bitset_reset_all(bitset_t *bitset)
+{
+    assert(bitset);
+    memset(bitset->words, 0, WORD_COUNT(bitset->nbits) * sizeof(uint64_t));
+}
+
+void bitset_flip_all(bitset_t *bitset)
+{
+    size_t nwords;
+
+    assert(bitset);
+
+    nwords = WORD_COUNT(bitset->nbits);
+    for (size_t i = 0; i < nwords; i++) {
+        bitset->words[i] = ~bitset->words[i];
+    }
+    __clear_tail(bitset);
+}
+
+size_t bitset_count(const bitset_t *bitset)
+{
+    assert(bitset);
+    return COUNT_WORDS(bitset->words, WORD_COUNT(bitset->nbits));
+}
+
+bool bitset_any(const bitset_t *bitset)
+{
+    size_t nwords;
+
+    assert(bitset);
+
+    nwords = WORD_COUNT(bitset->nbits);
+    for (size_t i = 0; i < nwords; i++) {
+        if (bitset->words[i]) return true;
+    }
+    return false;
+}
+
+bool bitset_equals(const bitset_t *lhs, const bitset_t *rhs)
+{
+    assert(lhs && rhs);
+
+    // 尾部的位总是0，所以可以直接比较所有的字
+    return lhs->nbits == rhs->nbits
+        && memcmp(lhs->words, rhs->words, WORD_COUNT(lhs->nbits) * sizeof(uint64_t)) == 0;
+}
+
+size_t bitset_find_first(const bitset_t *bitset)
+{
+    return bitset_find_next(bitset, 0);
+}
+
+size_t bitset_find_next(const bitset_t *bitset, size_t from)
+{
+    size_t index, nwords;
+    uint64_t word;
+
+    assert(bitset);
+
+    if (from >= bitset->nbits) return bitset->nbits;
+
+    // 第一个字去掉from之前的位，之后跳过所有为0的字，找到的字中最低的置位就是结果
+    index = from / BITSET_WORD_BITS;
+    nwords = WORD_COUNT(bitset->nbits);
+    word = bitset->words[index] & (ALL_ONES << (from % BITSET_WORD_BITS));
+    while (word == 0) {
+        if (++ index == nwords) return bitset->nbits;
+        word = bitset->words[index];
+    }
+    return index * BITSET_WORD_BITS + (size_t)__builtin_ctzll(word);
+}
+
+// 集合运算的循环体中没有分支，编译器可以自动向量化
+#define DEFINE_BITSET_OP(name, expr) \
+void bitset_##name(bitset_t *dst, const bitset_t *src) \
+{ \
+    size_t nwords; \
+    uint64_t *a; \
+    const uint64_t *b; \
+    assert(dst && src && dst->nbits == src->nbits); \
+    nwords = WORD_COUNT(dst->nbits); \
+    a = dst->words; \
+    b = src->words; \
+    for (size_t i = 0; i < nwords; i++) { \
+        a[i] = expr; \
+    } \
+}
+
+DEFINE_BITSET_OP(and, a[i] & b[i])
+DEFINE_BITSET_OP(or, a[i] | b[i])
+DEFINE_BITSET_OP(xor, a[i] ^ b[i])
+DEFINE_BITSET_OP(andnot, a[i] & ~b[i])
+
+#undef DEFINE_BITSET_OP
+#undef COUNT_WORDS
+#undef ALL_ONES
+#undef WORD_COUNT
+#undef BITSET_X86
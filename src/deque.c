@@ -0,0 +1,210 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 18:02:37
+*/
+#include <assert.h>
+#include <string.h>
+
+#include "deque.h"
+#include "leak.h"
+
+#define DEQUE_MIN_CAPACITY 8
+
+// 第index个元素在缓冲区中的地址，容量是2的幂，所以取模可以使用按位与
+#define ELEM(deque, index) \
+    ((char*)(deque)->beg + (((deque)->head + (index)) & ((deque)->capacity - 1)) * (deque)->unit_size)
+
+static inline size_t
+__round_up_pow2(size_t n)
+{
+    size_t capacity = DEQUE_MIN_CAPACITY;
+
+    while (capacity < n) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// 扩容到new_capacity，环绕到缓冲区开头的那部分元素搬到原来的末尾之后，保证元素仍然是连续的
+static void
+__deque_realloc(deque_t *deque, size_t new_capacity)
+{
+    size_t old_capacity = deque->capacity;
+
+    deque->beg = cstl_realloc(deque->beg, new_capacity * deque->unit_size);
+    deque->capacity = new_capacity;
+
+    if (deque->head + deque->len > old_capacity) {
+        size_t wrapped = deque->head + deque->len - old_capacity;
+        memcpy((char*)deque->beg + old_capacity * deque->unit_size, deque->beg,
+                wrapped * deque->unit_size);
+    }
+}
+
+static inline void
+__deque_grow(deque_t *deque)
+{
+    if (deque->len == deque->capacity) {
+        __deque_realloc(deque, deque->capacity * 2);
+    }
+}
+
+// 将index位置的元素交给调用者或者销毁掉
+static inline void
+__deque_take(deque_t *deque, size_t index, void *result)
+{
+    if (result) {
+        memcpy(result, ELEM(deque, index), deque->unit_size);
+    } else if (deque->destroy_func) {
+        (*deque->destroy_func)(ELEM(deque, index));
+    }
+}
+
+deque_t *deque_new(size_t unit_size, destroy_func_t destroy)
+{
+    return deque_new_with_capacity(unit_size, destroy, DEQUE_MIN_CAPACITY);
+}
+
+deque_t *deque_new_with_capacity(size_t unit_size, destroy_func_t destroy, size_t capacity)
+{
+    deque_t *deque;
+
+    assert(unit_size > 0);
+
+    deque = (deque_t*)cstl_malloc(sizeof(deque_t));
+    deque->head = 0;
+    deque->len = 0;
+    deque->capacity = __round_up_pow2(capacity);
+    deque->unit_size = unit_size;
+    deque->destroy_func = destroy;
+    deque->beg = cstl_malloc(deque->capacity * unit_size);
+    return deque;
+}
+
+void deque_free(deque_t *deque)
+{
+    assert(deque);
+
+    deque_clear(deque);
+    cstl_free(deque->beg);
+    cstl_free(deque);
+}
+
+size_t deque_size(const deque_t *deque)
+{
+    assert(deque);
+    return deque->len;
+}
+
+bool deque_empty(const deque_t *deque)
+{
+    assert(deque);
+    return deque->len == 0;
+}
+
+size_t deque_capacity(const deque_t *deque)
+{
+    assert(deque);
+    return deque->capacity;
+}
+
+void deque_reserve(deque_t *deque, size_t capacity)
+{
+    assert(deque);
+
+    if (capacity > deque->capacity) {
+        __deque_realloc(deque, __round_up_pow2(capacity));
+    }
+}
+
+void deque_push_front(deque_t *deque, const void *elem)
+{
+    assert(deque && elem);
+
+    __deque_grow(deque);
+    deque->head = (deque->head - 1) & (deque->capacity - 1);
+    ++ deque->len;
+    memcpy(ELEM(deque, 0), elem, deque->unit_size);
+}
+
+void deque_push_back(deque_t *deque, const void *elem)
+{
+    assert(deque && elem);
+
+    __deque_grow(deque);
+    memcpy(ELEM(deque, deque->len), elem, deque->unit_size);
+    ++ deque->len;
+}
+
+void deque_pop_front(deque_t *deque, void *result)
+{
+    assert(deque && deque->len > 0);
+
+    __deque_take(deque, 0, result);
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+    -- deque->len;
+}
+
+void deque_pop_back(deque_t *deque, void *result)
+{
+    assert(deque && deque->len > 0);
+
+    __deque_take(deque, deque->len - 1, result);
+    -- deque->len;
+}
+
+void *deque_front(deque_t *deque)
+{
+    return deque_get(deque, 0);
+}
+
+void *deque_back(deque_t *deque)
+{
+    assert(deque);
+    return deque->len > 0 ? ELEM(deque, deque->len - 1) : NULL;
+}
+
+void *deque_get(deque_t *deque, size_t index)
+{
+    assert(deque);
+    return index < deque->len ? ELEM(deque, index) : NULL;
+}
+
+void deque_set(deque_t *deque, size_t index, const void *value)
+{
+    assert(deque && value);
+
+    if (index >= deque->len) return;
+
+    if (deque->destroy_func) {
+        (*deque->destroy_func)(ELEM(deque, index));
+    }
+    memcpy(ELEM(deque, index), value, deque->unit_size);
+}
+
+void deque_clear(deque_t *deque)
+{
+    assert(deque);
+
+    if (deque->destroy_func) {
+        for (size_t i = 0; i < deque->len; i++) {
+            (*deque->destroy_func)(ELEM(deque, i));
+        }
+    }
+    deque->head = 0;
+    deque->len = 0;
+}
+
+void deque_foreach(deque_t *deque, deque_foreach_func_t foreach_func, void *user_data)
+{
+    assert(deque && foreach_func);
+
+    for (size_t i = 0; i < deque->len; i++) {
+        (*foreach_func)(ELEM(deque, i), user_data);
+    }
+}
+
+#undef ELEM
+#undef DEQUE_MIN_CAPACITY
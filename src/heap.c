@@ -0,0 +1,259 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 17:20:46
+*/
+#include <assert.h>
+#include <string.h>
+
+#include "heap.h"
+#include "leak.h"
+
+#define ARITY 4     // 每个节点的子节点数目
+
+#define ELEM(heap, index) ((char*)(heap)->data->beg + (size_t)(index) * (heap)->data->unit_size)
+#define UNIT_SIZE(heap) ((size_t)(heap)->data->unit_size)
+
+// 将src复制到index位置，并且通知调用者元素的新位置
+static inline void
+__place(heap_t *heap, size_t index, const void *src)
+{
+    memcpy(ELEM(heap, index), src, UNIT_SIZE(heap));
+    if (heap->index_func) {
+        (*heap->index_func)(ELEM(heap, index), index);
+    }
+}
+
+// 将index位置的元素向上调整，返回它最终的位置。使用空位的方式移动，每一层只复制一次
+static size_t
+__sift_up(heap_t *heap, size_t index)
+{
+    memcpy(heap->tmp, ELEM(heap, index), UNIT_SIZE(heap));
+
+    while (index > 0) {
+        size_t parent = (index - 1) / ARITY;
+        if (heap->cmp_func(heap->tmp, ELEM(heap, parent)) >= 0) break;
+        __place(heap, index, ELEM(heap, parent));
+        index = parent;
+    }
+    __place(heap, index, heap->tmp);
+    return index;
+}
+
+// 将index位置的元素向下调整，返回它最终的位置
+static size_t
+__sift_down(heap_t *heap, size_t index)
+{
+    size_t size = vec_size(heap->data);
+
+    memcpy(heap->tmp, ELEM(heap, index), UNIT_SIZE(heap));
+
+    for (;;) {
+        size_t first = index * ARITY + 1;
+        size_t last = first + ARITY;
+        size_t best = first;
+
+        if (first >= size) break;
+        if (last > size) last = size;
+
+        for (size_t child = first + 1; child < last; child++) {
+            if (heap->cmp_func(ELEM(heap, child), ELEM(heap, best)) < 0) {
+                best = child;
+            }
+        }
+        if (heap->cmp_func(ELEM(heap, best), heap->tmp) >= 0) break;
+
+        __place(heap, index, ELEM(heap, best));
+        index = best;
+    }
+    __place(heap, index, heap->tmp);
+    return index;
+}
+
+static inline void
+__sift(heap_t *heap, size_t index)
+{
+    if (__sift_up(heap, index) == index) {
+        __sift_down(heap, index);
+    }
+}
+
+// 将index位置的元素交给调用者或者销毁掉
+static inline void
+__take(heap_t *heap, size_t index, void *result)
+{
+    if (result) {
+        memcpy(result, ELEM(heap, index), UNIT_SIZE(heap));
+    } else if (heap->destroy_func) {
+        (*heap->destroy_func)(ELEM(heap, index));
+    }
+}
+
+static heap_t *
+__heap_new(VEC *data, cmp_func_t cmp_func, destroy_func_t destroy_func)
+{
+    heap_t *heap = (heap_t*)cstl_malloc(sizeof(heap_t));
+
+    heap->data = data;
+    heap->cmp_func = cmp_func;
+    heap->destroy_func = destroy_func;
+    heap->index_func = NULL;
+    heap->tmp = cstl_malloc(data->unit_size);
+    return heap;
+}
+
+heap_t *heap_new(int unit_size, cmp_func_t cmp_func, destroy_func_t destroy_func)
+{
+    assert(unit_size > 0 && cmp_func);
+
+    // 元素由heap自己销毁，这样移除元素的时候可以选择把所有权交给调用者
+    return __heap_new(vec_new(unit_size, NULL), cmp_func, destroy_func);
+}
+
+heap_t *heap_new_from_vec(VEC *vec, cmp_func_t cmp_func)
+{
+    heap_t *heap;
+    size_t size;
+
+    assert(vec && cmp_func);
+
+    heap = __heap_new(vec, cmp_func, vec->destroy_func);
+    vec->destroy_func = NULL;
+
+    // 从最后一个非叶子节点开始向下调整，总的时间复杂度是O(n)
+    size = vec_size(vec);
+    if (size > 1) {
+        for (size_t i = (size - 2) / ARITY + 1; i-- > 0; ) {
+            __sift_down(heap, i);
+        }
+    }
+    return heap;
+}
+
+void heap_free(heap_t *heap)
+{
+    assert(heap);
+
+    heap_clear(heap);
+    vec_free(heap->data);
+    cstl_free(heap->tmp);
+    cstl_free(heap);
+}
+
+void heap_set_index_func(heap_t *heap, heap_index_func_t index_func)
+{
+    assert(heap);
+
+    heap->index_func = index_func;
+    if (index_func) {
+        size_t size = vec_size(heap->data);
+        for (size_t i = 0; i < size; i++) {
+            (*index_func)(ELEM(heap, i), i);
+        }
+    }
+}
+
+void heap_push(heap_t *heap, const void *value)
+{
+    assert(heap && value);
+
+    vec_push_back(heap->data, value);
+    __sift_up(heap, vec_size(heap->data) - 1);
+}
+
+void *heap_top(heap_t *heap)
+{
+    assert(heap);
+    return heap_empty(heap) ? NULL : ELEM(heap, 0);
+}
+
+void heap_pop(heap_t *heap, void *result)
+{
+    assert(heap && !heap_empty(heap));
+    heap_remove(heap, 0, result);
+}
+
+void heap_replace_top(heap_t *heap, const void *value, void *result)
+{
+    assert(heap && value && !heap_empty(heap));
+
+    __take(heap, 0, result);
+    memcpy(ELEM(heap, 0), value, UNIT_SIZE(heap));
+    __sift_down(heap, 0);
+}
+
+void *heap_get(heap_t *heap, size_t index)
+{
+    assert(heap && index < heap_size(heap));
+    return ELEM(heap, index);
+}
+
+void heap_decrease_key(heap_t *heap, size_t index, const void *value)
+{
+    assert(heap && value && index < heap_size(heap));
+    assert(heap->cmp_func(value, ELEM(heap, index)) <= 0);
+
+    memcpy(ELEM(heap, index), value, UNIT_SIZE(heap));
+    __sift_up(heap, index);
+}
+
+void heap_update(heap_t *heap, size_t index)
+{
+    assert(heap && index < heap_size(heap));
+    __sift(heap, index);
+}
+
+void heap_remove(heap_t *heap, size_t index, void *result)
+{
+    size_t last;
+
+    assert(heap && index < heap_size(heap));
+
+    __take(heap, index, result);
+
+    // 使用最后一个元素填补空位，然后重新调整它的位置
+    last = vec_size(heap->data) - 1;
+    if (index != last) {
+        memcpy(ELEM(heap, index), ELEM(heap, last), UNIT_SIZE(heap));
+    }
+    vec_pop_back(heap->data);
+    if (index < last) {
+        __sift(heap, index);
+    }
+}
+
+void heap_clear(heap_t *heap)
+{
+    assert(heap);
+
+    if (heap->destroy_func) {
+        size_t size = vec_size(heap->data);
+        for (size_t i = 0; i < size; i++) {
+            (*heap->destroy_func)(ELEM(heap, i));
+        }
+    }
+    vec_clear_keep_capacity(heap->data);
+}
+
+size_t heap_size(const heap_t *heap)
+{
+    assert(heap);
+    return vec_size(heap->data);
+}
+
+bool heap_empty(const heap_t *heap)
+{
+    assert(heap);
+    return vec_empty(heap->data);
+}
+
+const VEC *heap_data(const heap_t *heap)
+{
+    assert(heap);
+    return heap->data;
+}
+
+#undef UNIT_SIZE
+#undef ELEM
+#undef ARITY
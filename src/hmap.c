@@ -15,6 +15,9 @@
 #define KEY(entry) (entry)
 #define VALUE(entry, key_size) ((char*)(entry)+ key_size)
 
+// 每个桶内置存储的元素数目，大多数桶的元素都很少，这样每个桶只需要一次内存分配
+#define BUCKET_INLINE_CAPACITY 4
+
 static inline void
 __free(void *ptr)
 {
@@ -69,7 +72,7 @@ HMAP *hmap_new_with_destroy_func(int key_size, int value_size
     int entry_size = key_size + value_size;
 
     for (int i = 0; i < BUCKET_SIZE; i++) {
-        hmap->buckets[i] = vec_new(entry_size, NULL);
+        hmap->buckets[i] = vec_new_small(entry_size, NULL, BUCKET_INLINE_CAPACITY);
     }
 
     hmap->key_size = key_size;
@@ -161,6 +164,24 @@ void *hmap_get(const HMAP *hmap, const void *key)
     return NULL;
 }
 
+void *hmap_get_with(const HMAP *hmap, const void *probe,
+        hash_func_t probe_hash, cmp_func_t probe_cmp)
+{
+    assert(hmap && probe && probe_hash && probe_cmp);
+
+    VEC *bucket = hmap->buckets[probe_hash(probe) % BUCKET_SIZE];
+    void *entry;
+
+    for (int i = 0; i < vec_size(bucket); i++) {
+        entry = vec_get(bucket, i);
+        if (probe_cmp(probe, KEY(entry)) == 0) {
+            return VALUE(entry, hmap->key_size);
+        }        
+    }
+
+    return NULL;
+}
+
 void *hmap_find(const HMAP *hmap, const void *key)
 {
     return hmap_get(hmap, key);
@@ -238,25 +259,19 @@ void hmap_erase(HMAP *hmap, const void *key)
 // 删除所有的元素
 void hmap_clear(HMAP *hmap)
 {
-    int entry_size = hmap->key_size + hmap->value_size;
-
     assert(hmap);
 
-    // 删除老的，构建新的
+    // 清空所有的桶，桶会回到内置存储上，不需要重新创建
     for (int i = 0; i < BUCKET_SIZE; i++) {
         for (int j = 0; j < vec_size(hmap->buckets[i]); j++) {
             __destroy_entry(vec_get(hmap->buckets[i], j), hmap->key_size,
                     hmap->key_destroy, hmap->val_destroy);
         }
-        vec_free(hmap->buckets[i]);
-    }
-
-    // 构建新的
-    for (int i = 0; i < BUCKET_SIZE; i++) {
-        hmap->buckets[i] = vec_new(entry_size, NULL);
+        vec_clear(hmap->buckets[i]);
     }
     hmap->len = 0;
 }
 
 #undef KEY
 #undef VALUE
+#undef BUCKET_INLINE_CAPACITY
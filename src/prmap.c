@@ -0,0 +1,474 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 10:12:40
+*/
+#include "prmap.h"
+#include "leak.h"
+
+#include <assert.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+
+// 持久化的平衡二叉树使用的是AVL树，节点一旦被发布就不会再被修改，
+// 修改操作只复制从根节点到修改位置的路径上的节点，其余节点由新老版本共享，
+// 所以节点中没有parent指针，并且使用引用计数来管理
+
+// AVL树的高度最多是1.44*log2(n)，对于64位系统上所有可能的元素数目都足够
+#define PRMAP_MAX_HEIGHT 96
+
+typedef struct prmap_node_t {
+    struct prmap_node_t *left;
+    struct prmap_node_t *right;
+    int refcount;           // 被多少个父节点或者快照引用
+    int height;             // 以此节点为根的子树的高度，叶子节点为1
+    char data[];            // key和value紧挨着节点存放，只需要一次内存分配
+} prmap_node_t;
+
+typedef struct prmap_t {
+    prmap_node_t *root;
+    size_t len;
+    int refcount;
+
+    size_t key_size;
+    size_t value_size;
+    cmp_func_t cmp;
+} prmap_t;
+
+// 快照的发布使用hazard pointer：
+// - 读线程先占用一个槽位，把读到的current保存在槽位中，再确认current没有被替换，然后增加引用计数，最后清空槽位。
+//   每个槽位占用一个缓存行，不同的读线程使用不同的槽位，读线程之间没有共享的写操作
+// - 写线程替换current之后，如果有槽位保存着老的快照，说明有读线程正在获取它的引用，
+//   先把它放到retired中，之后每次发布的时候再检查，没有槽位保存它的时候才释放，写线程从来不等待读线程
+// - 一个槽位同时只能保存一个快照，所以retired中最多有PRMAP_CELL_SLOTS + 1个快照
+
+#define PRMAP_CELL_SLOTS 64     // 最多可以同时获取引用的读线程数目，超过时候其余的读线程等待空闲的槽位
+#define CACHE_LINE_SIZE 64
+#define SLOT_BUSY ((prmap_t*)1) // 槽位已经被占用，但是还没有保存快照
+
+typedef struct {
+    prmap_t *pmap;
+    char pad[CACHE_LINE_SIZE - sizeof(prmap_t*)];
+} prmap_slot_t;
+
+typedef struct prmap_cell_t {
+    prmap_t *current;           // 当前发布的快照
+    prmap_slot_t *slots;        // 按照缓存行对齐的槽位
+    char *slots_mem;            // 分配的槽位内存，slots在其中对齐
+    prmap_t **retired;          // 已经被替换但是还不能释放的快照，只有写线程访问
+    size_t retired_len;
+} prmap_cell_t;
+
+#define KEY(node) ((const void*)(node)->data)
+#define VALUE(pmap, node) ((const void*)((node)->data + (pmap)->key_size))
+
+static inline int __height(const prmap_node_t *node)
+{
+    return (node == NULL) ? 0 : node->height;
+}
+
+static inline prmap_node_t *__node_ref(prmap_node_t *node)
+{
+    if (node != NULL) {
+        __atomic_add_fetch(&node->refcount, 1, __ATOMIC_RELAXED);
+    }
+    return node;
+}
+
+static void __node_unref(prmap_node_t *node)
+{
+    // 只会沿着不再被引用的节点向下释放，所以递归深度最多是树的高度
+    if (node != NULL && 0 == __atomic_sub_fetch(&node->refcount, 1, __ATOMIC_ACQ_REL)) {
+        __node_unref(node->left);
+        __node_unref(node->right);
+        cstl_free(node);
+    }
+}
+
+// 新建一个节点，left和right的引用会转移给新节点
+static prmap_node_t *__node_new(const prmap_t *pmap, prmap_node_t *left, prmap_node_t *right,
+        const void *key, const void *value)
+{
+    prmap_node_t *node = (prmap_node_t*)cstl_malloc(sizeof(prmap_node_t)
+            + pmap->key_size + pmap->value_size);
+
+    node->left = left;
+    node->right = right;
+    node->refcount = 1;
+    node->height = CSTL_MAX(__height(left), __height(right)) + 1;
+    memcpy(node->data, key, pmap->key_size);
+    memcpy(node->data + pmap->key_size, value, pmap->value_size);
+    return node;
+}
+
+static inline prmap_node_t *__node_copy(const prmap_t *pmap, prmap_node_t *left,
+        prmap_node_t *right, const prmap_node_t *src)
+{
+    return __node_new(pmap, left, right, KEY(src), VALUE(pmap, src));
+}
+
+// 使用src的数据，以left和right为孩子构建一个平衡的子树，left和right的引用会被转移
+// 调用时候left和right的高度差最多为2
+static prmap_node_t *__balance(const prmap_t *pmap, prmap_node_t *left, prmap_node_t *right,
+        const prmap_node_t *src)
+{
+    prmap_node_t *root;
+    int hl = __height(left);
+    int hr = __height(right);
+
+    if (hl > hr + 1) {
+        if (__height(left->left) >= __height(left->right)) { // 右旋
+            root = __node_copy(pmap, __node_ref(left->left),
+                    __node_copy(pmap, __node_ref(left->right), right, src), left);
+        } else { // 先左旋后右旋
+            prmap_node_t *lr = left->right;
+            root = __node_copy(pmap,
+                    __node_copy(pmap, __node_ref(left->left), __node_ref(lr->left), left),
+                    __node_copy(pmap, __node_ref(lr->right), right, src),
+                    lr);
+        }
+        __node_unref(left);
+        return root;
+    }
+
+    if (hr > hl + 1) {
+        if (__height(right->right) >= __height(right->left)) { // 左旋
+            root = __node_copy(pmap,
+                    __node_copy(pmap, left, __node_ref(right->left), src),
+                    __node_ref(right->right), right);
+        } else { // 先右旋后左旋
+            prmap_node_t *rl = right->left;
+            root = __node_copy(pmap,
+                    __node_copy(pmap, left, __node_ref(rl->left), src),
+                    __node_copy(pmap, __node_ref(rl->right), __node_ref(right->right), right),
+                    rl);
+        }
+        __node_unref(right);
+        return root;
+    }
+
+    return __node_copy(pmap, left, right, src);
+}
+
+// 返回插入后的新子树(新的引用)，原来的子树不会被修改
+static prmap_node_t *__insert(const prmap_t *pmap, prmap_node_t *node,
+        const void *key, const void *value, bool *added)
+{
+    int rs;
+
+    if (node == NULL) {
+        *added = true;
+        return __node_new(pmap, NULL, NULL, key, value);
+    }
+
+    rs = (*pmap->cmp)(key, KEY(node));
+    if (rs < 0) {
+        return __balance(pmap, __insert(pmap, node->left, key, value, added),
+                __node_ref(node->right), node);
+    } else if (rs > 0) {
+        return __balance(pmap, __node_ref(node->left),
+                __insert(pmap, node->right, key, value, added), node);
+    }
+
+    *added = false;
+    return __node_new(pmap, __node_ref(node->left), __node_ref(node->right),
+            KEY(node), value);
+}
+
+// 返回删除最小节点之后的新子树
+static prmap_node_t *__erase_min(const prmap_t *pmap, prmap_node_t *node)
+{
+    if (node->left == NULL) {
+        return __node_ref(node->right);
+    }
+    return __balance(pmap, __erase_min(pmap, node->left), __node_ref(node->right), node);
+}
+
+// 返回删除key之后的新子树，如果key不存在，那么返回的就是原来子树的一个引用
+static prmap_node_t *__erase(const prmap_t *pmap, prmap_node_t *node,
+        const void *key, bool *removed)
+{
+    prmap_node_t *child, *smallest;
+    int rs;
+
+    if (node == NULL) {
+        *removed = false;
+        return NULL;
+    }
+
+    rs = (*pmap->cmp)(key, KEY(node));
+    if (rs < 0) {
+        child = __erase(pmap, node->left, key, removed);
+        if (!*removed) {
+            __node_unref(child);
+            return __node_ref(node);
+        }
+        return __balance(pmap, child, __node_ref(node->right), node);
+    } else if (rs > 0) {
+        child = __erase(pmap, node->right, key, removed);
+        if (!*removed) {
+            __node_unref(child);
+            return __node_ref(node);
+        }
+        return __balance(pmap, __node_ref(node->left), child, node);
+    }
+
+    *removed = true;
+    if (node->left == NULL) return __node_ref(node->right);
+    if (node->right == NULL) return __node_ref(node->left);
+
+    // 使用右子树中最小的节点来代替被删除的节点
+    smallest = node->right;
+    while (smallest->left != NULL) {
+        smallest = smallest->left;
+    }
+    return __balance(pmap, __node_ref(node->left), __erase_min(pmap, node->right), smallest);
+}
+
+static prmap_t *__prmap_new_version(const prmap_t *pmap, prmap_node_t *root, size_t len)
+{
+    prmap_t *version = (prmap_t*)cstl_malloc(sizeof(prmap_t));
+
+    version->root = root;
+    version->len = len;
+    version->refcount = 1;
+    version->key_size = pmap->key_size;
+    version->value_size = pmap->value_size;
+    version->cmp = pmap->cmp;
+    return version;
+}
+
+CSTL_LIB prmap_t *prmap_new(size_t key_size, size_t value_size, cmp_func_t key_cmp_func)
+{
+    prmap_t tmpl = {
+        .key_size = key_size,
+        .value_size = value_size,
+        .cmp = key_cmp_func
+    };
+
+    assert(key_cmp_func && "key compare function can't be null!");
+    return __prmap_new_version(&tmpl, NULL, 0);
+}
+
+CSTL_LIB prmap_t *prmap_ref(prmap_t *pmap)
+{
+    assert(pmap && "pmap cannot be null");
+    __atomic_add_fetch(&pmap->refcount, 1, __ATOMIC_RELAXED);
+    return pmap;
+}
+
+CSTL_LIB void prmap_free(prmap_t *pmap)
+{
+    assert(pmap && "pmap cannot be null");
+    if (0 == __atomic_sub_fetch(&pmap->refcount, 1, __ATOMIC_ACQ_REL)) {
+        __node_unref(pmap->root);
+        cstl_free(pmap);
+    }
+}
+
+CSTL_LIB prmap_t *prmap_insert(const prmap_t *pmap, const void *key, const void *value)
+{
+    prmap_node_t *root;
+    bool added = false;
+
+    assert(pmap && key && value && "pmap key value cannot be null");
+    root = __insert(pmap, pmap->root, key, value, &added);
+    return __prmap_new_version(pmap, root, pmap->len + (added ? 1 : 0));
+}
+
+CSTL_LIB prmap_t *prmap_erase(const prmap_t *pmap, const void *key)
+{
+    prmap_node_t *root;
+    bool removed = false;
+
+    assert(pmap && key && "pmap key cannot be null");
+    root = __erase(pmap, pmap->root, key, &removed);
+    return __prmap_new_version(pmap, root, pmap->len - (removed ? 1 : 0));
+}
+
+CSTL_LIB const void *prmap_get(const prmap_t *pmap, const void *key)
+{
+    const prmap_node_t *node;
+
+    assert(pmap && key && "pmap key cannot be null");
+
+    node = pmap->root;
+    while (node != NULL) {
+        int rs = (*pmap->cmp)(key, KEY(node));
+        if (0 == rs) {
+            return VALUE(pmap, node);
+        }
+        node = (rs < 0) ? node->left : node->right;
+    }
+    return NULL;
+}
+
+CSTL_LIB bool prmap_has_key(const prmap_t *pmap, const void *key)
+{
+    return NULL != prmap_get(pmap, key);
+}
+
+CSTL_LIB size_t prmap_size(const prmap_t *pmap)
+{
+    assert(pmap && "pmap cannot be null");
+    return pmap->len;
+}
+
+CSTL_LIB bool prmap_empty(const prmap_t *pmap)
+{
+    return prmap_size(pmap) == 0;
+}
+
+// 使用固定大小的栈进行中序遍历，lo和hi为NULL表示没有下界或者上界
+static void __prmap_traverse(const prmap_t *pmap, const void *lo, const void *hi,
+        PRMAP_FOR_EACH each, void *user_data)
+{
+    const prmap_node_t *stack[PRMAP_MAX_HEIGHT];
+    const prmap_node_t *node = pmap->root;
+    int top = 0;
+
+    for (;;) {
+        // 沿着左侧下降，跳过比lo小的子树
+        while (node != NULL) {
+            if (lo != NULL && (*pmap->cmp)(KEY(node), lo) < 0) {
+                node = node->right;
+            } else {
+                assert(top < PRMAP_MAX_HEIGHT);
+                stack[top++] = node;
+                node = node->left;
+            }
+        }
+
+        if (top == 0) return;
+
+        node = stack[--top];
+        if (hi != NULL && (*pmap->cmp)(KEY(node), hi) > 0) return;
+
+        if (node->right != NULL) CSTL_PREFETCH(node->right);
+        each(KEY(node), VALUE(pmap, node), user_data);
+        node = node->right;
+    }
+}
+
+CSTL_LIB void prmap_for_each(const prmap_t *pmap, PRMAP_FOR_EACH for_each_func, void *user_data)
+{
+    assert(pmap && for_each_func && "pmap for_each_func cannot be null");
+    __prmap_traverse(pmap, NULL, NULL, for_each_func, user_data);
+}
+
+CSTL_LIB void prmap_for_each_range(const prmap_t *pmap, const void *lo, const void *hi,
+        PRMAP_FOR_EACH for_each_func, void *user_data)
+{
+    assert(pmap && lo && hi && for_each_func && "pmap lo hi for_each_func cannot be null");
+    __prmap_traverse(pmap, lo, hi, for_each_func, user_data);
+}
+
+CSTL_LIB prmap_cell_t *prmap_cell_new(prmap_t *pmap)
+{
+    prmap_cell_t *cell = (prmap_cell_t*)cstl_malloc(sizeof(prmap_cell_t));
+
+    assert(pmap && "pmap cannot be null");
+    cell->current = pmap;
+    cell->slots_mem = (char*)cstl_malloc(PRMAP_CELL_SLOTS * sizeof(prmap_slot_t) + CACHE_LINE_SIZE);
+    cell->slots = (prmap_slot_t*)(((uintptr_t)cell->slots_mem + CACHE_LINE_SIZE - 1)
+            & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+    for (int i = 0; i < PRMAP_CELL_SLOTS; i++) {
+        cell->slots[i].pmap = NULL;
+    }
+    cell->retired = (prmap_t**)cstl_malloc((PRMAP_CELL_SLOTS + 1) * sizeof(prmap_t*));
+    cell->retired_len = 0;
+    return cell;
+}
+
+CSTL_LIB void prmap_cell_free(prmap_cell_t *cell)
+{
+    assert(cell && "cell cannot be null");
+    for (size_t i = 0; i < cell->retired_len; i++) {
+        prmap_free(cell->retired[i]);
+    }
+    prmap_free(cell->current);
+    cstl_free(cell->retired);
+    cstl_free(cell->slots_mem);
+    cstl_free(cell);
+}
+
+// 占用一个空闲的槽位，每个线程从自己固定的位置开始查找，所以读线程不多的时候它们总是使用不同的槽位
+static prmap_slot_t *__slot_claim(prmap_cell_t *cell)
+{
+    static __thread unsigned hint = 0;      // 0表示还没有分配
+    static unsigned next_hint = 0;
+
+    if (hint == 0) {
+        hint = __atomic_add_fetch(&next_hint, 1, __ATOMIC_RELAXED);
+    }
+    for (unsigned i = 0; ; i++) {
+        prmap_slot_t *slot = &cell->slots[(hint + i) % PRMAP_CELL_SLOTS];
+        prmap_t *expect = NULL;
+
+        if (__atomic_load_n(&slot->pmap, __ATOMIC_RELAXED) == NULL
+                && __atomic_compare_exchange_n(&slot->pmap, &expect, SLOT_BUSY, false,
+                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return slot;
+        }
+        // 所有的槽位都在使用，让出cpu给正在获取引用的读线程
+        if ((i + 1) % PRMAP_CELL_SLOTS == 0) {
+            sched_yield();
+        }
+    }
+}
+
+static bool __slot_protects(const prmap_cell_t *cell, const prmap_t *pmap)
+{
+    for (int i = 0; i < PRMAP_CELL_SLOTS; i++) {
+        if (__atomic_load_n(&cell->slots[i].pmap, __ATOMIC_SEQ_CST) == pmap) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CSTL_LIB prmap_t *prmap_cell_acquire(prmap_cell_t *cell)
+{
+    prmap_slot_t *slot;
+    prmap_t *pmap, *check;
+
+    assert(cell && "cell cannot be null");
+    slot = __slot_claim(cell);
+    pmap = __atomic_load_n(&cell->current, __ATOMIC_SEQ_CST);
+    for (;;) {
+        // 保存到槽位之后current仍然是它，说明写线程替换current的时候一定能在槽位中看到它
+        __atomic_store_n(&slot->pmap, pmap, __ATOMIC_SEQ_CST);
+        check = __atomic_load_n(&cell->current, __ATOMIC_SEQ_CST);
+        if (check == pmap) break;
+        pmap = check;
+    }
+    prmap_ref(pmap);
+    __atomic_store_n(&slot->pmap, NULL, __ATOMIC_RELEASE);
+    return pmap;
+}
+
+CSTL_LIB void prmap_cell_publish(prmap_cell_t *cell, prmap_t *pmap)
+{
+    size_t i = 0;
+
+    assert(cell && pmap && "cell pmap cannot be null");
+    cell->retired[cell->retired_len++] = __atomic_exchange_n(&cell->current, pmap, __ATOMIC_SEQ_CST);
+
+    // 释放所有没有被槽位保护的快照，包括刚刚替换掉的那个
+    while (i < cell->retired_len) {
+        if (__slot_protects(cell, cell->retired[i])) {
+            ++ i;
+        } else {
+            prmap_free(cell->retired[i]);
+            cell->retired[i] = cell->retired[--cell->retired_len];
+        }
+    }
+}
+
+#undef SLOT_BUSY
+#undef CACHE_LINE_SIZE
+#undef PRMAP_CELL_SLOTS
+#undef KEY
+#undef VALUE
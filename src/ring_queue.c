@@ -0,0 +1,336 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 18:40:15
+*/
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ring_queue.h"
+#include "leak.h"
+
+#define CACHE_LINE_SIZE 64
+
+// 索引都是单调递增的，只在访问缓冲区的时候才和mask按位与，这样满和空可以直接通过索引的差来判断
+
+struct spsc_queue_t {
+    char *buffer;
+    size_t mask;                    // 容量减1
+    size_t unit_size;
+    destroy_func_t destroy_func;
+
+    char pad0[CACHE_LINE_SIZE];
+    size_t tail;                    // 下一个入队的位置，只有生产者修改
+    size_t cached_head;             // 生产者最近一次读取到的head，减少对消费者缓存行的访问
+
+    char pad1[CACHE_LINE_SIZE];
+    size_t head;                    // 下一个出队的位置，只有消费者修改
+    size_t cached_tail;             // 消费者最近一次读取到的tail
+
+    char pad2[CACHE_LINE_SIZE];
+};
+
+// 槽位由序号和元素组成，序号等于pos表示位置pos可以入队，等于pos+1表示位置pos可以出队
+struct mpmc_queue_t {
+    char *cells;
+    size_t mask;
+    size_t unit_size;
+    size_t cell_size;
+    destroy_func_t destroy_func;
+
+    char pad0[CACHE_LINE_SIZE];
+    size_t enqueue_pos;
+
+    char pad1[CACHE_LINE_SIZE];
+    size_t dequeue_pos;
+
+    char pad2[CACHE_LINE_SIZE];
+};
+
+#define SPSC_SLOT(queue, pos) ((queue)->buffer + ((pos) & (queue)->mask) * (queue)->unit_size)
+
+#define MPMC_CELL(queue, pos) ((queue)->cells + ((pos) & (queue)->mask) * (queue)->cell_size)
+#define MPMC_SEQ(cell) ((size_t*)(cell))
+#define MPMC_DATA(cell) ((cell) + sizeof(size_t))
+
+static inline size_t
+__round_up_pow2(size_t n)
+{
+    size_t capacity = 1;
+
+    while (capacity < n) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// 复制环形缓冲区中从pos开始的count个元素，最多分成两段
+static void
+__spsc_copy_in(spsc_queue_t *queue, size_t pos, const char *elems, size_t count)
+{
+    size_t first = queue->mask + 1 - (pos & queue->mask);
+
+    if (first > count) first = count;
+    memcpy(SPSC_SLOT(queue, pos), elems, first * queue->unit_size);
+    memcpy(queue->buffer, elems + first * queue->unit_size, (count - first) * queue->unit_size);
+}
+
+static void
+__spsc_copy_out(const spsc_queue_t *queue, size_t pos, char *results, size_t count)
+{
+    size_t first = queue->mask + 1 - (pos & queue->mask);
+
+    if (first > count) first = count;
+    memcpy(results, SPSC_SLOT(queue, pos), first * queue->unit_size);
+    memcpy(results + first * queue->unit_size, queue->buffer, (count - first) * queue->unit_size);
+}
+
+spsc_queue_t *spsc_queue_new(size_t unit_size, destroy_func_t destroy, size_t capacity)
+{
+    spsc_queue_t *queue;
+
+    assert(unit_size > 0 && capacity > 0);
+
+    queue = (spsc_queue_t*)cstl_malloc(sizeof(spsc_queue_t));
+    capacity = __round_up_pow2(capacity);
+    queue->buffer = (char*)cstl_malloc(capacity * unit_size);
+    queue->mask = capacity - 1;
+    queue->unit_size = unit_size;
+    queue->destroy_func = destroy;
+    queue->tail = queue->cached_head = 0;
+    queue->head = queue->cached_tail = 0;
+    return queue;
+}
+
+void spsc_queue_free(spsc_queue_t *queue)
+{
+    assert(queue);
+
+    if (queue->destroy_func) {
+        for (size_t pos = queue->head; pos != queue->tail; pos++) {
+            (*queue->destroy_func)(SPSC_SLOT(queue, pos));
+        }
+    }
+    cstl_free(queue->buffer);
+    cstl_free(queue);
+}
+
+bool spsc_queue_push(spsc_queue_t *queue, const void *elem)
+{
+    return spsc_queue_push_batch(queue, elem, 1) == 1;
+}
+
+bool spsc_queue_pop(spsc_queue_t *queue, void *result)
+{
+    return spsc_queue_pop_batch(queue, result, 1) == 1;
+}
+
+size_t spsc_queue_push_batch(spsc_queue_t *queue, const void *elems, size_t count)
+{
+    size_t tail, space;
+
+    assert(queue && (elems || count == 0));
+
+    tail = queue->tail;
+    space = queue->mask + 1 - (tail - queue->cached_head);
+    if (space < count) {
+        // 缓存的head已经过时了，重新读取一次
+        queue->cached_head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        space = queue->mask + 1 - (tail - queue->cached_head);
+    }
+    if (count > space) count = space;
+    if (count == 0) return 0;
+
+    __spsc_copy_in(queue, tail, (const char*)elems, count);
+    __atomic_store_n(&queue->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+size_t spsc_queue_pop_batch(spsc_queue_t *queue, void *results, size_t count)
+{
+    size_t head, avail;
+
+    assert(queue && (results || count == 0));
+
+    head = queue->head;
+    avail = queue->cached_tail - head;
+    if (avail < count) {
+        queue->cached_tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+        avail = queue->cached_tail - head;
+    }
+    if (count > avail) count = avail;
+    if (count == 0) return 0;
+
+    __spsc_copy_out(queue, head, (char*)results, count);
+    __atomic_store_n(&queue->head, head + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+size_t spsc_queue_size(const spsc_queue_t *queue)
+{
+    size_t head, tail;
+
+    assert(queue);
+
+    // 先读head，tail只会比它更大
+    head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    return tail - head;
+}
+
+size_t spsc_queue_capacity(const spsc_queue_t *queue)
+{
+    assert(queue);
+    return queue->mask + 1;
+}
+
+mpmc_queue_t *mpmc_queue_new(size_t unit_size, destroy_func_t destroy, size_t capacity)
+{
+    mpmc_queue_t *queue;
+
+    assert(unit_size > 0 && capacity > 0);
+
+    // 容量为1的时候，出队之后的序号和入队之后的序号相同，没有办法区分，所以最小是2
+    capacity = __round_up_pow2(capacity < 2 ? 2 : capacity);
+
+    queue = (mpmc_queue_t*)cstl_malloc(sizeof(mpmc_queue_t));
+    queue->mask = capacity - 1;
+    queue->unit_size = unit_size;
+    queue->cell_size = sizeof(size_t) + (unit_size + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+    queue->destroy_func = destroy;
+    queue->cells = (char*)cstl_malloc(capacity * queue->cell_size);
+    for (size_t pos = 0; pos < capacity; pos++) {
+        *MPMC_SEQ(MPMC_CELL(queue, pos)) = pos;
+    }
+    queue->enqueue_pos = 0;
+    queue->dequeue_pos = 0;
+    return queue;
+}
+
+void mpmc_queue_free(mpmc_queue_t *queue)
+{
+    assert(queue);
+
+    if (queue->destroy_func) {
+        for (size_t pos = queue->dequeue_pos; pos != queue->enqueue_pos; pos++) {
+            (*queue->destroy_func)(MPMC_DATA(MPMC_CELL(queue, pos)));
+        }
+    }
+    cstl_free(queue->cells);
+    cstl_free(queue);
+}
+
+bool mpmc_queue_push(mpmc_queue_t *queue, const void *elem)
+{
+    return mpmc_queue_push_batch(queue, elem, 1) == 1;
+}
+
+bool mpmc_queue_pop(mpmc_queue_t *queue, void *result)
+{
+    return mpmc_queue_pop_batch(queue, result, 1) == 1;
+}
+
+// 从pos开始，连续有多少个槽位的序号等于它的位置加上offset(入队是0，出队是1)，最多检查count个
+static inline size_t
+__mpmc_ready_count(mpmc_queue_t *queue, size_t pos, size_t count, size_t offset)
+{
+    size_t n = 0;
+
+    while (n < count && n <= queue->mask) {
+        size_t seq = __atomic_load_n(MPMC_SEQ(MPMC_CELL(queue, pos + n)), __ATOMIC_ACQUIRE);
+        if (seq != pos + n + offset) break;
+        ++ n;
+    }
+    return n;
+}
+
+// 竞争从*pos_ptr开始的最多count个连续位置，返回得到的数目，*claimed保存第一个位置。
+// 槽位的序号落后于期望值说明队列满了(入队)或者空了(出队)，超前说明被其他线程抢先了，需要重新读取位置。
+// 检查序号之后，只有竞争到这些位置的线程才能修改这些槽位，所以CAS成功之后它们仍然是可用的
+static size_t
+__mpmc_claim(mpmc_queue_t *queue, size_t *pos_ptr, size_t count, size_t offset, size_t *claimed)
+{
+    size_t pos = __atomic_load_n(pos_ptr, __ATOMIC_RELAXED);
+
+    for (;;) {
+        size_t n = __mpmc_ready_count(queue, pos, count, offset);
+
+        if (n == 0) {
+            size_t seq = __atomic_load_n(MPMC_SEQ(MPMC_CELL(queue, pos)), __ATOMIC_ACQUIRE);
+            if ((intptr_t)(seq - (pos + offset)) < 0) return 0;
+            pos = __atomic_load_n(pos_ptr, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        // 失败的时候pos会被更新为最新的值
+        if (__atomic_compare_exchange_n(pos_ptr, &pos, pos + n, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            *claimed = pos;
+            return n;
+        }
+    }
+}
+
+size_t mpmc_queue_push_batch(mpmc_queue_t *queue, const void *elems, size_t count)
+{
+    size_t pos, n;
+
+    assert(queue && (elems || count == 0));
+
+    if (count == 0) return 0;
+
+    n = __mpmc_claim(queue, &queue->enqueue_pos, count, 0, &pos);
+    for (size_t i = 0; i < n; i++) {
+        char *cell = MPMC_CELL(queue, pos + i);
+        memcpy(MPMC_DATA(cell), (const char*)elems + i * queue->unit_size, queue->unit_size);
+        __atomic_store_n(MPMC_SEQ(cell), pos + i + 1, __ATOMIC_RELEASE);
+    }
+    return n;
+}
+
+size_t mpmc_queue_pop_batch(mpmc_queue_t *queue, void *results, size_t count)
+{
+    size_t pos, n;
+
+    assert(queue && (results || count == 0));
+
+    if (count == 0) return 0;
+
+    n = __mpmc_claim(queue, &queue->dequeue_pos, count, 1, &pos);
+    for (size_t i = 0; i < n; i++) {
+        char *cell = MPMC_CELL(queue, pos + i);
+        memcpy((char*)results + i * queue->unit_size, MPMC_DATA(cell), queue->unit_size);
+        // 槽位留给下一圈的位置pos + i + capacity入队
+        __atomic_store_n(MPMC_SEQ(cell), pos + i + queue->mask + 1, __ATOMIC_RELEASE);
+    }
+    return n;
+}
+
+size_t mpmc_queue_size(const mpmc_queue_t *queue)
+{
+    size_t dequeue_pos, enqueue_pos;
+
+    assert(queue);
+
+    // 消费者竞争到的位置一定已经被生产者竞争过，所以先读dequeue_pos
+    dequeue_pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_ACQUIRE);
+    enqueue_pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_ACQUIRE);
+    if (enqueue_pos - dequeue_pos > queue->mask + 1) {
+        return queue->mask + 1;
+    }
+    return enqueue_pos - dequeue_pos;
+}
+
+size_t mpmc_queue_capacity(const mpmc_queue_t *queue)
+{
+    assert(queue);
+    return queue->mask + 1;
+}
+
+#undef MPMC_DATA
+#undef MPMC_SEQ
+#undef MPMC_CELL
+#undef SPSC_SLOT
+#undef CACHE_LINE_SIZE
@@ -26,6 +26,7 @@ typedef struct rb_node_t {
     struct rb_node_t *right;
     struct rb_node_t *parent;
     rb_color_t color;
+    size_t size; // 以此节点为根的子树中节点的数目，只有tree->rank为true时候才维护
 
     any_t data; // 保存的真正用户需要的数据
 } rb_node_t;
@@ -44,14 +45,16 @@ static inline rb_node_t* grandparent(rb_node_t *node)
     return NULL;
 }
 
+// 父亲的兄弟节点
 static inline rb_node_t* uncle(rb_node_t *node)
 {
     rb_node_t *p = parent(node);
-    if (p != NULL) {
-        if (node == p->left) {
-            return p->right;
+    rb_node_t *g = grandparent(node);
+    if (g != NULL) {
+        if (p == g->left) {
+            return g->right;
         } else {
-            return p->left;
+            return g->left;
         }
     }
     return NULL;
@@ -73,6 +76,7 @@ typedef struct rb_tree_t {
     rb_node_t *NIL;
 
     size_t len;
+    bool rank;              //是否维护子树尺寸，用来支持O(log n)的rank/select
 
     size_t key_size;        //表示key占用的尺寸
     size_t value_size;      //value占用的尺寸
@@ -98,7 +102,8 @@ static void rb_tree_rotate_left(rb_tree_t *tree, rb_node_t *x)
     // y节点的左子节点设置为x节点的右子节点 
     rb_node_t *y = x->right;
     x->right = y->left;
-    if (y->left) y->left->parent = x;
+    // 删除调整时候NIL的parent有意义，不能在这儿被改掉
+    if (y->left != tree->NIL) y->left->parent = x;
 
     // 建立y节点x原来父节点的连接
     y->parent = x->parent;
@@ -113,6 +118,11 @@ static void rb_tree_rotate_left(rb_tree_t *tree, rb_node_t *x)
     // 设置x和y之间的相互连接关系
     y->left = x;
     x->parent = y;
+
+    if (tree->rank) { // 只有x和y的子树发生了变化
+        y->size = x->size;
+        x->size = x->left->size + x->right->size + 1;
+    }
 }
 
 // 以y为支点进行右旋转
@@ -122,7 +132,7 @@ static void rb_tree_rotate_right(rb_tree_t *tree, rb_node_t *y)
     // 建立y左子树和x右子树之间的连接关系
     rb_node_t *x = y->left;
     y->left = x->right;
-    if (x->right) x->right->parent = y;
+    if (x->right != tree->NIL) x->right->parent = y;
 
     // 建立x父亲和y原来的父亲之间的链接关系
     x->parent = y->parent;
@@ -137,6 +147,11 @@ static void rb_tree_rotate_right(rb_tree_t *tree, rb_node_t *y)
     // 建立x和y之间的连接关系
     x->right = y;
     y->parent = x;
+
+    if (tree->rank) {
+        x->size = y->size;
+        y->size = y->left->size + y->right->size + 1;
+    }
 }
 
 static inline void* rb_tree_get_key(rb_tree_t UNUSED *tree, rb_node_t *node)
@@ -149,33 +164,48 @@ static inline void* rb_tree_get_value(rb_tree_t *tree, rb_node_t *node)
     return (char*)node->data + tree->key_size;
 }
 
-static inline int rb_tree_cmp_node(rb_tree_t *tree, rb_node_t *left, rb_node_t *right)
-{
-    return tree->cmp(rb_tree_get_key(tree, left),
-            rb_tree_get_key(tree, right));
+
+static void rb_tree_insert_rebalance(rb_tree_t *tree, rb_node_t *z);
+
+static inline void rb_tree_destroy_value(rb_tree_t *tree, void *value) {
+    if (tree->value_destroy) {
+        (*tree->value_destroy)(value);
+    }
 }
 
+static rb_node_t *rb_tree_find_node(rb_tree_t *tree, const void *key);
+static void* rb_tree_find(rb_tree_t *tree, const void* key);
 
-static void rb_tree_insert_rebalance(rb_tree_t *tree, rb_node_t *z);
-static void rb_tree_insert_node(rb_tree_t *tree, rb_node_t *z)
+// 只从根节点向下查找一次：如果key已经存在，则直接返回对应的节点，
+// 否则在查找停下来的位置上挂接新的节点（不用再从根节点查找插入点）
+static rb_node_t *rb_tree_find_or_insert_node(rb_tree_t *tree, const void *key,
+        const void *value, bool *inserted)
 {
     rb_node_t *y = NULL;
     rb_node_t *x = tree->root;
+    rb_node_t *z;
+    int rs = 0;
 
-    // 查找插入点的位置（叶子结点）
     while (x != NULL && x != tree->NIL) {
         y = x;
-        if (rb_tree_cmp_node(tree, z, x) < 0) {
-            x = x->left;
-        } else {
-            x = x->right;
+        rs = (*tree->cmp)(key, rb_tree_get_key(tree, x));
+        if (0 == rs) {
+            *inserted = false;
+            return x;
         }
+        x = (rs < 0) ? x->left : x->right;
     }
 
+    z = (rb_node_t*)cstl_malloc(sizeof(rb_node_t));
+    z->data = cstl_malloc(tree->key_size + tree->value_size);
+    memmove(z->data, key, tree->key_size);
+    memmove((char*)z->data + tree->key_size, value, tree->value_size);
+
+    // 最后一次比较的结果就决定了挂在父节点的哪一侧
     z->parent = y;
     if (y == NULL) {
         tree->root = z;
-    } else if (rb_tree_cmp_node(tree, z, y) < 0) {
+    } else if (rs < 0) {
         y->left = z;
     } else {
         y->right = z;
@@ -184,28 +214,30 @@ static void rb_tree_insert_node(rb_tree_t *tree, rb_node_t *z)
     // 初始化z的状态
     z->left = z->right = tree->NIL;
     z->color = RED;
-    rb_tree_insert_rebalance(tree, z);
-}
+    z->size = 1;
+    ++ tree->len;
 
-static inline void rb_tree_destroy_value(rb_tree_t *tree, void *value) {
-    if (tree->value_destroy) {
-        (*tree->value_destroy)(value);
+    // 旋转时候是根据孩子来重新计算尺寸的，所以要先更新好所有祖先节点
+    if (tree->rank) {
+        for (x = y; x != NULL; x = x->parent) {
+            ++ x->size;
+        }
     }
-}
+    rb_tree_insert_rebalance(tree, z);
 
-static bool rb_tree_set_value(rb_tree_t *tree, const void *key, const void *value);
-static rb_node_t *rb_tree_find_node(rb_tree_t *tree, const void *key);
-static void* rb_tree_find(rb_tree_t *tree, const void* key);
+    *inserted = true;
+    return z;
+}
 
 static void rb_tree_insert(rb_tree_t *tree, const void *key, const void *value)
 {
-    if (!rb_tree_set_value(tree, key, value)) { //创建新的
-        ++ tree->len;
-        rb_node_t *node = (rb_node_t*)cstl_malloc(sizeof(rb_node_t));
-        node->data = cstl_malloc(tree->key_size + tree->value_size);
-        memmove(node->data, key, tree->key_size);
-        memmove((char*)node->data + tree->key_size, value, tree->value_size);
-        rb_tree_insert_node(tree, node);
+    bool inserted;
+    rb_node_t *node = rb_tree_find_or_insert_node(tree, key, value, &inserted);
+
+    if (!inserted) { // 已经存在，替换掉原来的值
+        void *val = rb_tree_get_value(tree, node);
+        rb_tree_destroy_value(tree, val); //先销毁原来的
+        memmove(val, value, tree->value_size); // 设置新的
     }
 }
 
@@ -221,17 +253,20 @@ static bool rb_tree_set_value(rb_tree_t *tree, const void *key, const void *valu
     return false;
 }
 
+// 使用循环代替递归，只有父亲和叔叔都是红色的时候才需要继续向上调整
 static void rb_tree_insert_rebalance(rb_tree_t *tree, rb_node_t *z)
 {
-    if (NULL == z->parent) {
-        z->color = BLACK; // 根节点颜色设置为黑色就可以
-    } else if (parent(z)->color == BLACK) {
-        //nothing to dao
-    } else if (uncle(z) && uncle(z)->color == RED) {
-        uncle(z)->color = parent(z)->color = BLACK;
-        grandparent(z)->color = RED;
-        rb_tree_insert_rebalance(tree, grandparent(z));
-    } else { //uncle节点要么不存在，要么为黑色
+    while (NULL != z->parent && parent(z)->color == RED) {
+        // 父亲是红色，所以父亲肯定不是根节点，祖父一定存在
+        rb_node_t *u = uncle(z);
+        if (u && u->color == RED) {
+            u->color = parent(z)->color = BLACK;
+            grandparent(z)->color = RED;
+            z = grandparent(z);
+            continue;
+        }
+
+        //uncle节点要么不存在，要么为黑色
         // 处理后，s, p和p位于同一侧
         // 原来s和p有4种排序，现在经过转换只能能有2两
         // 要么都是位于左侧，要么都是位于右侧
@@ -252,7 +287,10 @@ static void rb_tree_insert_rebalance(rb_tree_t *tree, rb_node_t *z)
             //z == parent(z)->right && parent(z) == grandparent(z)->right
             rb_tree_rotate_left(tree, grandparent(z));
         }
+        break;
     }
+
+    tree->root->color = BLACK; // 根节点颜色设置为黑色就可以
 }
 
 static void rb_tree_swap(rb_tree_t *tree, rb_node_t *left, rb_node_t *right)
@@ -281,6 +319,13 @@ static void rb_tree_erase(rb_tree_t *tree, rb_node_t *z)
     // 可能是NIL，可能 不是NIL
     child = (z->left == tree->NIL) ? z->right : z->left;
 
+    // 先将z从所有祖先节点的子树尺寸中去掉，后面的旋转依赖于正确的尺寸
+    if (tree->rank) {
+        for (rb_node_t *p = z->parent; p != NULL; p = p->parent) {
+            -- p->size;
+        }
+    }
+
     // 要删除的节点是树上唯一一个节点
     if (z->parent == NULL && z->left == tree->NIL && z->right == tree->NIL) {
         tree->root = NULL;
@@ -318,50 +363,58 @@ destroy_node:
 
 static void rb_tree_erase_rebalance(rb_tree_t *tree, rb_node_t *n)
 {
-    rb_node_t *s = sibling(n);
-    if (n->parent == NULL) return;
+    rb_node_t *s;
 
-    if (s->color == RED) {
-        n->parent->color = RED;
-        s->color = BLACK;
-        if (n == parent(n)->left) {
-            rb_tree_rotate_left(tree, parent(n));
-        } else {
-            rb_tree_rotate_right(tree, parent(n));
-        }
+    // 只有父亲、兄弟和兄弟的孩子都是黑色时，才需要将问题上移到父节点，使用循环代替递归
+    while (n->parent != NULL) {
         s = sibling(n);
-    }
+        if (s->color == RED) {
+            n->parent->color = RED;
+            s->color = BLACK;
+            if (n == parent(n)->left) {
+                rb_tree_rotate_left(tree, parent(n));
+            } else {
+                rb_tree_rotate_right(tree, parent(n));
+            }
+            s = sibling(n);
+        }
 
-    if (parent(n)->color == BLACK && s->color == BLACK &&
-            s->left->color==BLACK && s->right->color==BLACK) {
-        return rb_tree_erase_rebalance(tree, n);
-    } else if (parent(n)->color == RED && s->color == BLACK
-            && s->left->color == BLACK && s->right->color == BLACK) {
-        s->color = RED;
-        parent(n)->color = BLACK;
-    } else if (s->color == BLACK) {
-        if (n == parent(n)->left && BLACK == s->right->color && RED == s->left->color) {
+        if (parent(n)->color == BLACK && s->color == BLACK &&
+                s->left->color==BLACK && s->right->color==BLACK) {
+            // 兄弟子树也少一个黑色节点，问题上移到父节点
             s->color = RED;
-            s->left->color = BLACK;
-            rb_tree_rotate_right(tree, s);
-        } else if (n == parent(n)->right && BLACK == s->left->color &&
-            RED == s->right->color) {
+            n = parent(n);
+            continue;
+        } else if (parent(n)->color == RED && s->color == BLACK
+                && s->left->color == BLACK && s->right->color == BLACK) {
             s->color = RED;
-            s->right->color = BLACK;
-            rb_tree_rotate_left(tree, s);
+            parent(n)->color = BLACK;
+            return; // 交换父亲和兄弟的颜色就已经平衡了
+        } else if (s->color == BLACK) {
+            if (n == parent(n)->left && BLACK == s->right->color && RED == s->left->color) {
+                s->color = RED;
+                s->left->color = BLACK;
+                rb_tree_rotate_right(tree, s);
+            } else if (n == parent(n)->right && BLACK == s->left->color &&
+                RED == s->right->color) {
+                s->color = RED;
+                s->right->color = BLACK;
+                rb_tree_rotate_left(tree, s);
+            }
+            s = sibling(n);
         }
-        s = sibling(n);
-    }
 
-    s->color = n->parent->color;
-    n->parent->color = BLACK;
+        s->color = n->parent->color;
+        n->parent->color = BLACK;
 
-    if (n == parent(n)->left) {
-        s->right->color = BLACK;
-        rb_tree_rotate_left(tree, parent(n));
-    } else {
-        s->left->color = BLACK;
-        rb_tree_rotate_right(tree, parent(n));
+        if (n == parent(n)->left) {
+            s->right->color = BLACK;
+            rb_tree_rotate_left(tree, parent(n));
+        } else {
+            s->left->color = BLACK;
+            rb_tree_rotate_right(tree, parent(n));
+        }
+        return;
     }
 }
 
@@ -378,12 +431,36 @@ static void rb_tree_destroy_node(rb_tree_t *tree, rb_node_t *node)
     cstl_free(node);
 }
 
-static inline void _rb_tree_free_all_node(rb_tree_t *tree, rb_node_t *node)
+// 利用parent指针进行后序遍历来释放所有的节点，不使用递归，所以栈的使用量是固定的
+// 每个节点的孩子都释放掉后，将它从父亲上摘下来，然后再释放它，最后回到父亲节点
+static void _rb_tree_free_all_node(rb_tree_t *tree, rb_node_t *node)
 {
-    if (node == tree->NIL || NULL == node) return;
-    _rb_tree_free_all_node(tree, node->left);
-    _rb_tree_free_all_node(tree, node->right);
-    rb_tree_destroy_node(tree, node);
+    rb_node_t *p;
+
+    while (node != NULL && node != tree->NIL) {
+        if (node->left != tree->NIL) {
+            node = node->left;
+            CSTL_PREFETCH(node->left);
+            continue;
+        }
+        if (node->right != tree->NIL) {
+            node = node->right;
+            CSTL_PREFETCH(node->left);
+            continue;
+        }
+
+        p = node->parent;
+        if (p != NULL) {
+            if (p->left == node) {
+                p->left = tree->NIL;
+            } else {
+                p->right = tree->NIL;
+            }
+            CSTL_PREFETCH(p->right);
+        }
+        rb_tree_destroy_node(tree, node);
+        node = p;
+    }
 }
 
 // 释放内部所有资源
@@ -400,13 +477,21 @@ static void* rb_tree_find(rb_tree_t *tree, const void* key)
     return (node == NULL) ? NULL : rb_tree_get_value(tree, node);
 }
 
+static rb_node_t *rb_tree_find_node_with(rb_tree_t *tree, const void *key, cmp_func_t cmp);
+
 static rb_node_t *rb_tree_find_node(rb_tree_t *tree, const void *key)
+{
+    return rb_tree_find_node_with(tree, key, tree->cmp);
+}
+
+// cmp(key, 节点的key)，key可以和节点中保存的key类型不同，只要cmp和tree->cmp的顺序一致就可以
+static rb_node_t *rb_tree_find_node_with(rb_tree_t *tree, const void *key, cmp_func_t cmp)
 {
     rb_node_t *node = tree->root;
     if (node == NULL) return NULL;
 
     while (node != tree->NIL) {
-        int rs = (*tree->cmp)(key, rb_tree_get_key(tree, node));
+        int rs = (*cmp)(key, rb_tree_get_key(tree, node));
         if (0 == rs) {
             return node;
         } else if (rs < 0 ) {
@@ -419,18 +504,80 @@ static rb_node_t *rb_tree_find_node(rb_tree_t *tree, const void *key)
     return NULL;
 }
 
-static void rb_tree_for_each_impl(rb_tree_t *tree, rb_node_t *node, RMAP_FOR_EACH each, void *user_data)
+// 中序遍历中node的下一个节点，没有的话返回NULL
+static rb_node_t *rb_tree_successor(rb_tree_t *tree, rb_node_t *node)
 {
-    if (NULL == node || tree->NIL == node) return;
-    each(rb_tree_get_key(tree, node), rb_tree_get_value(tree, node), user_data);
-    rb_tree_for_each_impl(tree, node->left, each, user_data);
-    rb_tree_for_each_impl(tree, node->right, each, user_data);
+    rb_node_t *p;
+
+    if (node->right != tree->NIL) {
+        return rb_tree_smallest(tree, node->right);
+    }
+
+    p = node->parent;
+    while (p != NULL && node == p->right) {
+        node = p;
+        p = p->parent;
+    }
+    return p;
 }
 
+// 利用parent指针按照key从小到大的顺序进行遍历，不使用递归
 static void rb_tree_for_each(rb_tree_t *tree, RMAP_FOR_EACH each, void *data)
 {
+    rb_node_t *node, *next;
+
     if (NULL == tree->root || tree->NIL == tree->root ||  NULL == each) return;
-    rb_tree_for_each_impl(tree, tree->root, each, data);
+
+    node = rb_tree_smallest(tree, tree->root);
+    while (node != NULL) {
+        // 在回调之前就先找到下一个节点，并且预取它的数据
+        next = rb_tree_successor(tree, node);
+        if (next != NULL) CSTL_PREFETCH(next->data);
+
+        each(rb_tree_get_key(tree, node), rb_tree_get_value(tree, node), data);
+        node = next;
+    }
+}
+
+// 返回树中小于key(strict为true)或者小于等于key(strict为false)的节点数目
+static size_t rb_tree_count_less(rb_tree_t *tree, const void *key, bool strict)
+{
+    rb_node_t *node = tree->root;
+    size_t count = 0;
+
+    if (node == NULL) return 0;
+
+    while (node != tree->NIL) {
+        int rs = (*tree->cmp)(key, rb_tree_get_key(tree, node));
+        if (rs < 0 || (strict && 0 == rs)) {
+            node = node->left;
+        } else {
+            count += node->left->size + 1;
+            node = node->right;
+        }
+    }
+    return count;
+}
+
+// 返回中序遍历中第k个节点(从0开始)
+static rb_node_t *rb_tree_select(rb_tree_t *tree, size_t k)
+{
+    rb_node_t *node = tree->root;
+
+    if (node == NULL || k >= tree->len) return NULL;
+
+    while (node != tree->NIL) {
+        size_t left_size = node->left->size;
+        if (k < left_size) {
+            node = node->left;
+        } else if (k == left_size) {
+            return node;
+        } else {
+            k -= left_size + 1;
+            node = node->right;
+        }
+    }
+    return NULL;
 }
 
 // rmap_t
@@ -445,18 +592,21 @@ CSTL_LIB rmap_t *rmap_new(size_t key_size, size_t value_size,
             NULL, NULL);
 }
 
-CSTL_LIB rmap_t *rmap_new_with_destroy_func(size_t key_size, size_t value_size, 
+static rmap_t *__rmap_new(size_t key_size, size_t value_size, 
         key_cmp_func_t key_cmp_func,
         key_destroy_func_t key_destroy,
-        value_destroy_func_t val_destroy)
+        value_destroy_func_t val_destroy,
+        bool rank)
 {
     rmap_t *rmap = (rmap_t*)cstl_malloc(sizeof(rmap_t));
 
     rmap->tree.root = NULL;
     rmap->tree.NIL = (rb_node_t*)cstl_malloc(sizeof(rb_node_t));
     rmap->tree.NIL->color = BLACK;
+    rmap->tree.NIL->size = 0;
 
     rmap->tree.len = 0;
+    rmap->tree.rank = rank;
 
     rmap->tree.key_size = key_size;
     rmap->tree.value_size = value_size;
@@ -467,6 +617,24 @@ CSTL_LIB rmap_t *rmap_new_with_destroy_func(size_t key_size, size_t value_size,
     return rmap;
 }
 
+CSTL_LIB rmap_t *rmap_new_with_destroy_func(size_t key_size, size_t value_size, 
+        key_cmp_func_t key_cmp_func,
+        key_destroy_func_t key_destroy,
+        value_destroy_func_t val_destroy)
+{
+    return __rmap_new(key_size, value_size, key_cmp_func, key_destroy,
+            val_destroy, false);
+}
+
+CSTL_LIB rmap_t *rmap_new_with_rank(size_t key_size, size_t value_size, 
+        key_cmp_func_t key_cmp_func,
+        key_destroy_func_t key_destroy,
+        value_destroy_func_t val_destroy)
+{
+    return __rmap_new(key_size, value_size, key_cmp_func, key_destroy,
+            val_destroy, true);
+}
+
 CSTL_LIB void rmap_free(rmap_t *rmap)
 {
     assert(rmap && "rmap cannot be null");
@@ -481,6 +649,16 @@ CSTL_LIB void rmap_insert(rmap_t *rmap, const void *key, const void *value)
     rb_tree_insert(&rmap->tree, key, value);
 }
 
+CSTL_LIB void *rmap_get_or_insert(rmap_t *rmap, const void *key, const void *value,
+        bool *inserted)
+{
+    bool dummy;
+    assert(rmap && key && value && "rmap key value cannot be null");
+    rb_node_t *node = rb_tree_find_or_insert_node(&rmap->tree, key, value,
+            (inserted != NULL) ? inserted : &dummy);
+    return rb_tree_get_value(&rmap->tree, node);
+}
+
 CSTL_LIB void rmap_erase(rmap_t *rmap, const void *key)
 {
     assert(rmap && key && "rmap key cannot be null");
@@ -496,6 +674,15 @@ CSTL_LIB void *rmap_get(const rmap_t *rmap, const void *key)
     return rb_tree_find((rb_tree_t*)&rmap->tree, key);
 }
 
+CSTL_LIB void *rmap_get_with(const rmap_t *rmap, const void *probe, cmp_func_t probe_cmp)
+{
+    rb_node_t *node;
+
+    assert(rmap && probe && probe_cmp && "rmap probe probe_cmp cannot be null");
+    node = rb_tree_find_node_with((rb_tree_t*)&rmap->tree, probe, probe_cmp);
+    return (node == NULL) ? NULL : rb_tree_get_value((rb_tree_t*)&rmap->tree, node);
+}
+
 CSTL_LIB bool rmap_has_key(const rmap_t *rmap, const void *key)
 {
     assert(rmap && key && "rmap key cannot be null");
@@ -531,3 +718,36 @@ CSTL_LIB void rmap_for_each(rmap_t* rmap, RMAP_FOR_EACH for_each_func, void *use
     assert(rmap && "rmap cannot be null");
     rb_tree_for_each(&rmap->tree, for_each_func, user_data);
 }
+
+CSTL_LIB size_t rmap_rank(const rmap_t *rmap, const void *key)
+{
+    assert(rmap && key && "rmap key cannot be null");
+    assert(rmap->tree.rank && "rmap must be created by rmap_new_with_rank");
+    return rb_tree_count_less((rb_tree_t*)&rmap->tree, key, true);
+}
+
+CSTL_LIB const void *rmap_select(const rmap_t *rmap, size_t k, void **value)
+{
+    assert(rmap && "rmap cannot be null");
+    assert(rmap->tree.rank && "rmap must be created by rmap_new_with_rank");
+
+    rb_node_t *node = rb_tree_select((rb_tree_t*)&rmap->tree, k);
+    if (node == NULL) return NULL;
+
+    if (value != NULL) {
+        *value = rb_tree_get_value((rb_tree_t*)&rmap->tree, node);
+    }
+    return rb_tree_get_key((rb_tree_t*)&rmap->tree, node);
+}
+
+CSTL_LIB size_t rmap_count_range(const rmap_t *rmap, const void *lo, const void *hi)
+{
+    size_t below_lo, upto_hi;
+
+    assert(rmap && lo && hi && "rmap lo hi cannot be null");
+    assert(rmap->tree.rank && "rmap must be created by rmap_new_with_rank");
+
+    below_lo = rb_tree_count_less((rb_tree_t*)&rmap->tree, lo, true);
+    upto_hi = rb_tree_count_less((rb_tree_t*)&rmap->tree, hi, false);
+    return (upto_hi > below_lo) ? (upto_hi - below_lo) : 0;
+}
@@ -377,6 +377,39 @@ CSTL_EXPORT unsigned int   str_ptr_hash_code(str_t **str)
     return str_hash_code(*str);
 }
 
+// 和str_hash_code使用相同的算法
+CSTL_EXPORT unsigned int   str_slice_hash_code(const str_slice_t *slice)
+{
+    unsigned int hash = 0;
+
+    assert(slice);
+
+    for (size_t i = 0; i < slice->len; i++) {
+        hash += (unsigned char)*(slice->data + i);
+    }
+    return hash;
+}
+
+// 先比较公共部分，公共部分相同的话，短的字符串比较小
+static inline int __str_bytes_cmp(const char *lhv, size_t lhv_len, const char *rhv, size_t rhv_len)
+{
+    int rs = memcmp(lhv, rhv, CSTL_MIN(lhv_len, rhv_len));
+    if (rs != 0) return rs;
+    return (lhv_len < rhv_len) ? -1 : (lhv_len > rhv_len);
+}
+
+CSTL_EXPORT int   str_ptr_cmp(str_t **lhv, str_t **rhv)
+{
+    assert(lhv && rhv && *lhv && *rhv);
+    return __str_bytes_cmp((*lhv)->beg, (*lhv)->len, (*rhv)->beg, (*rhv)->len);
+}
+
+CSTL_EXPORT int   str_slice_ptr_cmp(const str_slice_t *slice, str_t **str)
+{
+    assert(slice && str && *str);
+    return __str_bytes_cmp(slice->data, slice->len, (*str)->beg, (*str)->len);
+}
+
 // 查找
 CSTL_EXPORT int  str_index_of(const str_t *str, int from_index, const char *val)
 {
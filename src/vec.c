@@ -5,17 +5,25 @@
 * Create time: 2017 09 30 16:28:31
 */
 #include <assert.h>
+#include <limits.h>
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <pthread.h>
+#if defined(LINUX) || defined(__unix__)
+#include <unistd.h>
+#endif
 
 #include "vec.h"
+#include "vec_num.h"
 #include "leak.h"
 
+// 计算至少还能再存放elem_count个元素的新容量
 static inline size_t
 __calc_new_capacity(VEC *vec, size_t elem_count)
 {
-    return vec_size(vec) + CSTL_MAX((size_t)vec_size(vec), elem_count);
+    size_t grown = (size_t)(vec_capacity(vec) * vec->growth_factor);
+    return CSTL_MAX(grown, vec_size(vec) + elem_count);
 }
 
 static inline void 
@@ -31,21 +39,129 @@ VEC *vec_new(int unit_size, destroy_func_t destroy_func)
     return vec_new_with_capacity(unit_size, destroy_func, 10);
 }
 
+static inline void
+__vec_init(VEC *vec, int unit_size, destroy_func_t destroy_func)
+{
+    vec->len = 0;
+    vec->unit_size = unit_size;
+    vec->destroy_func = destroy_func;
+    vec->growth_factor = 2.0f;
+    vec->inline_beg = NULL;
+    vec->inline_capacity = 0;
+}
+
+// beg是否指向内置的存储，内置的存储不能释放
+static inline bool
+__vec_is_inline(const VEC *vec)
+{
+    return vec->inline_beg != NULL && vec->beg == vec->inline_beg;
+}
+
+// 释放掉堆上的存储，回到内置的存储(如果有的话)
+static inline void
+__vec_release_buffer(VEC *vec)
+{
+    if (!__vec_is_inline(vec)) {
+        __free(vec->beg);
+    }
+    vec->beg = vec->inline_beg;
+    vec->capacity = vec->inline_capacity;
+}
+
 // capacity - 单位是元素的数目
 VEC *vec_new_with_capacity(int unit_size, destroy_func_t destroy_func,  int capacity)
 {
     int total_size = unit_size * capacity;
     VEC *new_vec = (VEC *)cstl_malloc(sizeof(VEC));
 
+    __vec_init(new_vec, unit_size, destroy_func);
     new_vec->capacity = capacity;
-    new_vec->len = 0;
-    new_vec->unit_size = unit_size;
-    new_vec->destroy_func = destroy_func;
-
     new_vec->beg = cstl_malloc(total_size);
     return new_vec;
 }
 
+// 内置的存储紧跟在VEC后面，按照16字节对齐
+#define VEC_INLINE_OFFSET ((sizeof(VEC) + 15) & ~(size_t)15)
+
+VEC *vec_new_small(int unit_size, destroy_func_t destroy_func, int inline_capacity)
+{
+    VEC *new_vec;
+
+    assert(unit_size > 0 && inline_capacity > 0);
+
+    new_vec = (VEC *)cstl_malloc(VEC_INLINE_OFFSET + (size_t)unit_size * inline_capacity);
+    __vec_init(new_vec, unit_size, destroy_func);
+    new_vec->inline_beg = (char*)new_vec + VEC_INLINE_OFFSET;
+    new_vec->inline_capacity = inline_capacity;
+    new_vec->beg = new_vec->inline_beg;
+    new_vec->capacity = inline_capacity;
+    return new_vec;
+}
+
+#undef VEC_INLINE_OFFSET
+
+void vec_init_with_buffer(VEC *vec, int unit_size, destroy_func_t destroy_func,
+        void *buffer, int capacity)
+{
+    assert(vec && unit_size > 0 && buffer && capacity > 0);
+
+    __vec_init(vec, unit_size, destroy_func);
+    vec->inline_beg = buffer;
+    vec->inline_capacity = capacity;
+    vec->beg = buffer;
+    vec->capacity = capacity;
+}
+
+void vec_deinit(VEC *vec)
+{
+    assert(vec);
+
+    vec_clear_keep_capacity(vec);
+    __vec_release_buffer(vec);
+}
+
+VEC *vec_new_from_buffer(int unit_size, destroy_func_t destroy_func, void *buffer,
+        size_t len, size_t capacity)
+{
+    VEC *new_vec;
+
+    assert(unit_size > 0 && buffer && len <= capacity && capacity <= INT_MAX);
+
+    new_vec = (VEC *)cstl_malloc(sizeof(VEC));
+    __vec_init(new_vec, unit_size, destroy_func);
+    new_vec->beg = buffer;
+    new_vec->len = (int)len;
+    new_vec->capacity = (int)capacity;
+    return new_vec;
+}
+
+void *vec_release(VEC *vec, size_t *len)
+{
+    void *buffer;
+
+    assert(vec);
+
+    if (len) *len = vec_size(vec);
+
+    if (__vec_is_inline(vec)) {
+        // 内置存储不能交给调用者，复制一份，至少分配一个元素，保证返回的不是NULL
+        size_t used = vec_size(vec) * vec->unit_size;
+        buffer = cstl_malloc(used > 0 ? used : (size_t)vec->unit_size);
+        memcpy(buffer, vec->beg, used);
+    } else {
+        buffer = vec->beg;
+    }
+
+    // 不销毁元素，回到内置的存储，或者没有任何存储的状态，下次插入时候再分配
+    vec->len = 0;
+    vec->beg = vec->inline_beg;
+    vec->capacity = vec->inline_capacity;
+    if (buffer == NULL) {
+        buffer = cstl_malloc(vec->unit_size);
+    }
+    return buffer;
+}
+
 inline size_t vec_capacity(const VEC *vec)
 {
     assert(vec);
@@ -58,12 +174,53 @@ inline size_t vec_size(const VEC *vec)
     return vec->len;
 }
 
-// 重新分配内部的保存数据的数组
+// 重新分配内部的保存数据的数组，有内置存储的时候，需要在内置存储和堆之间搬移
 static void
 __vec_realloc(VEC *vec, int new_capacity)
 {
+    size_t used = vec_size(vec) * vec->unit_size;
+
+    if (__vec_is_inline(vec)) {
+        if (new_capacity <= vec->inline_capacity) return;
+        vec->beg = cstl_malloc(new_capacity * vec->unit_size);
+        memcpy(vec->beg, vec->inline_beg, used);
+    } else if (vec->inline_beg != NULL && new_capacity <= vec->inline_capacity) {
+        memcpy(vec->inline_beg, vec->beg, used);
+        __free(vec->beg);
+        vec->beg = vec->inline_beg;
+        new_capacity = vec->inline_capacity;
+    } else {
+        vec->beg = cstl_realloc(vec->beg, new_capacity * vec->unit_size);
+    }
     vec->capacity = new_capacity;
-    vec->beg = cstl_realloc(vec->beg, vec->capacity * vec->unit_size);
+}
+
+void vec_reserve(VEC *vec, size_t capacity)
+{
+    assert(vec);
+
+    if (capacity > vec_capacity(vec)) {
+        __vec_realloc(vec, capacity);
+    }
+}
+
+void vec_shrink_to_fit(VEC *vec)
+{
+    assert(vec);
+
+    if (vec_capacity(vec) == vec_size(vec)) return;
+
+    if (vec_empty(vec)) {
+        __vec_release_buffer(vec);
+    } else {
+        __vec_realloc(vec, vec_size(vec));
+    }
+}
+
+void vec_set_growth_factor(VEC *vec, float factor)
+{
+    assert(vec && factor > 1.0f);
+    vec->growth_factor = factor;
 }
 
 void vec_resize(VEC *vec, size_t new_size, const void *value)
@@ -78,10 +235,25 @@ void vec_resize(VEC *vec, size_t new_size, const void *value)
         }
         vec->len = new_size;
     } else {
-        __vec_realloc(vec, new_size);
-        for (int i = vec_size(vec); i < (int)new_size; i++) {
-            vec_push_back(vec, value);
+        size_t unit = vec->unit_size;
+        size_t count = new_size - vec_size(vec);
+        size_t filled = 1;
+        char *dst;
+
+        assert(value);
+        if (new_size > vec_capacity(vec)) {
+            __vec_realloc(vec, __calc_new_capacity(vec, count));
+        }
+
+        // 先复制一个元素，然后每次复制已经填充好的部分，只需要O(log n)次memcpy
+        dst = (char*)vec->beg + vec_size(vec) * unit;
+        memcpy(dst, value, unit);
+        while (filled < count) {
+            size_t chunk = CSTL_MIN(filled, count - filled);
+            memcpy(dst + filled * unit, dst, chunk * unit);
+            filled += chunk;
         }
+        vec->len = new_size;
     }
 }
 
@@ -105,18 +277,7 @@ void vec_push_back(VEC *vec, const void *elem)
 void vec_push_front(VEC *vec, const void *elem)
 {
     assert(vec && elem != NULL);
-
-    if (vec_size(vec) >= vec_capacity(vec)) {
-        __vec_realloc(vec, __calc_new_capacity(vec, 1));
-    }
-
-    // 后面位置要挪移一位，这个时候不能够在调用memcpy, 因为他是从前往后复制，这样就会前面会覆盖掉后面的内容
-    for (int i = vec->len - 1; i >= 0; --i) {
-        __vec_put(vec, i + 1, vec_get(vec, i));
-    }
-
-    __vec_put(vec, 0, elem);
-    ++ vec->len;
+    vec_insert_array(vec, 0, elem, 1);
 }
 
 void vec_pop_front(VEC *vec)
@@ -145,6 +306,42 @@ void vec_erase(VEC *vec, size_t index)
             (vec->len - index) * vec->unit_size);
 }
 
+void vec_erase_range(VEC *vec, size_t from, size_t to)
+{
+    size_t len;
+
+    assert(vec);
+
+    len = vec_size(vec);
+    if (to > len) to = len;
+    if (from >= to) return;
+
+    if (vec->destroy_func) {
+        for (size_t i = from; i < to; i++) {
+            (*vec->destroy_func)(vec_get(vec, i));
+        }
+    }
+
+    memmove((char*)vec->beg + from * vec->unit_size, (char*)vec->beg + to * vec->unit_size,
+            (len - to) * vec->unit_size);
+    vec->len = len - (to - from);
+}
+
+void vec_swap_remove(VEC *vec, size_t index)
+{
+    assert(vec);
+    if (index >= vec_size(vec)) return;
+
+    if (vec->destroy_func) {
+        (*vec->destroy_func)(vec_get(vec, index));
+    }
+
+    -- vec->len;
+    if (index != (size_t)vec->len) {
+        memcpy(vec_get(vec, index), (char*)vec->beg + vec->len * vec->unit_size, vec->unit_size);
+    }
+}
+
 // 移除第一个出现的值
 void vec_remove(VEC *vec, const void *value, cmp_func_t compare)
 {
@@ -158,34 +355,78 @@ void vec_remove(VEC *vec, const void *value, cmp_func_t compare)
     }
 }
 
+typedef struct {
+    const void *value;
+    cmp_func_t compare;
+} __remove_value_t;
+
+static bool
+__equals_value(const void *elem, __remove_value_t *rm)
+{
+    return 0 == (*rm->compare)(rm->value, elem);
+}
+
 void vec_remove_all(VEC *vec, const void *value, cmp_func_t compare)
 {
+    __remove_value_t rm = {value, compare};
+
     assert(compare && "Must sepcify compare func in the remove method of vec!");
     assert(vec && "VEC can't be null!");
 
-    for (size_t i = 0; i < vec_size(vec);) {
-        if (0 == (*compare)(value, vec_get(vec, i))) {
-            vec_erase(vec, i);
-        } else {
-            i++;
+    vec_remove_if(vec, (vec_pred_func_t)__equals_value, &rm);
+}
+
+size_t vec_remove_if(VEC *vec, vec_pred_func_t pred, void *user_data)
+{
+    size_t unit, len, write = 0, keep_beg = 0;
+    char *beg;
+
+    assert(vec && pred);
+
+    unit = vec->unit_size;
+    len = vec_size(vec);
+    beg = (char*)vec->beg;
+
+    // [keep_beg, i)是一段连续需要保留的元素，遇到要移除的元素时候整段搬移到write的位置
+    for (size_t i = 0; i < len; i++) {
+        char *elem = beg + i * unit;
+        if (!(*pred)(elem, user_data)) continue;
+
+        if (vec->destroy_func) {
+            (*vec->destroy_func)(elem);
+        }
+        if (write != keep_beg) {
+            memmove(beg + write * unit, beg + keep_beg * unit, (i - keep_beg) * unit);
         }
+        write += i - keep_beg;
+        keep_beg = i + 1;
     }
+    if (write != keep_beg) {
+        memmove(beg + write * unit, beg + keep_beg * unit, (len - keep_beg) * unit);
+    }
+    write += len - keep_beg;
+
+    vec->len = write;
+    return len - write;
 }
 
-void vec_clear(VEC *vec)
+void vec_clear_keep_capacity(VEC *vec)
 {
     assert(vec);
-     
+
     if (vec->destroy_func != NULL) {
         for (size_t i = 0; i < vec_size(vec); i++) {
             (*vec->destroy_func)(vec_get(vec, i));
         }
     }
-
-    __free(vec->beg); //释放掉原来的内存
-    vec->beg = NULL;
     vec->len = 0;
-    vec->capacity = 0;
+}
+
+void vec_clear(VEC *vec)
+{
+    vec_clear_keep_capacity(vec);
+
+    __vec_release_buffer(vec); //释放掉原来的内存
 }
 
 inline bool vec_empty(const VEC *vec)
@@ -245,6 +486,16 @@ void *vec_find(VEC *vec, const void *val, cmp_func_t compare)
 {
     assert(vec && compare);
 
+    // 整数的比较函数就是判断是否相等，直接使用vec_num中的向量化实现
+    if (compare == CSTL_NUM_CMP_FUNC(int) && vec->unit_size == sizeof(int)) {
+        size_t index = int_vec_index_of(vec, *(const int*)val);
+        return vec_get(vec, index);
+    }
+    if (compare == CSTL_NUM_CMP_FUNC(long) && vec->unit_size == sizeof(long)) {
+        size_t index = long_vec_index_of(vec, *(const long*)val);
+        return vec_get(vec, index);
+    }
+
     for (size_t i = 0; i < vec_size(vec); i++) {
         if (0 == (*compare)(val, vec_get(vec, i))) {
             return vec_get(vec, i);
@@ -286,70 +537,226 @@ void *vec_bin_find(VEC *vec, const void *val,  cmp_func_t compare)
     return NULL;
 }
 
-static inline void 
-__vec_insert_middle(VEC *vec, int index, const void *elem)
+void vec_insert_array(VEC *vec, size_t index, const void *elems, size_t count)
 {
-    if (vec_size(vec) >= vec_capacity(vec)) {
-        __vec_realloc(vec, __calc_new_capacity(vec, 1));
+    size_t unit, len;
+    char *beg, *copy = NULL;
+
+    assert(vec && (elems != NULL || 0 == count));
+    if (0 == count) return;
+
+    unit = vec->unit_size;
+    len = vec_size(vec);
+    if (index > len) index = len;
+
+    // elems指向vec自身的元素时候，扩容和挪移都会改变它的内容，所以先复制一份
+    beg = (char*)vec->beg;
+    if (beg != NULL && (const char*)elems < beg + len * unit && (const char*)elems + count * unit > beg) {
+        copy = (char*)cstl_malloc(count * unit);
+        memcpy(copy, elems, count * unit);
+        elems = copy;
     }
 
-    for (int i = vec_size(vec) - 1; i >= index; i--) {
-        __vec_put(vec, i + 1, vec_get(vec, i));
+    if (len + count > vec_capacity(vec)) {
+        __vec_realloc(vec, __calc_new_capacity(vec, count));
     }
-    __vec_put(vec, index, elem);
-    ++ vec->len;
+
+    beg = (char*)vec->beg;
+    memmove(beg + (index + count) * unit, beg + index * unit, (len - index) * unit);
+    memcpy(beg + index * unit, elems, count * unit);
+    vec->len += count;
+
+    __free(copy);
+}
+
+void vec_append_array(VEC *vec, const void *elems, size_t count)
+{
+    assert(vec);
+    vec_insert_array(vec, vec_size(vec), elems, count);
 }
 
 void vec_insert(VEC *vec, size_t index, const void *elem)
 {
     assert(vec && elem != NULL);
-    
-    if (0 == index) {
-        vec_push_front(vec, elem);
-    } else if (index >= vec_size(vec)) {
-        vec_push_back(vec, elem);
-    } else {
-        __vec_insert_middle(vec, index, elem);
-    }
+    vec_insert_array(vec, index, elem, 1);
 }
 
 void vec_extend(VEC *vec, int index, const VEC *insert_vec)
 {
     assert(vec && insert_vec && index >= 0);
+    vec_insert_array(vec, index, insert_vec->beg, vec_size(insert_vec));
+}
+
+void vec_extend_front(VEC *vec, const VEC *insert_vec)
+{
+    vec_extend(vec, 0, insert_vec);
+}
+
+void vec_extend_back(VEC *vec, const VEC *insert_vec)
+{
+    vec_extend(vec, vec_size(vec), insert_vec);
+}
+
+size_t vec_lower_bound(const VEC *vec, const void *val, cmp_func_t compare)
+{
+    size_t lo = 0, hi;
+
+    assert(vec && compare);
 
-    if (vec_size(vec) + vec_size(insert_vec) > vec_capacity(vec)) {
-        __vec_realloc(vec, __calc_new_capacity(vec, vec_size(insert_vec)));
+    hi = vec_size(vec);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((*compare)((char*)vec->beg + mid * vec->unit_size, val) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
     }
+    return lo;
+}
+
+size_t vec_upper_bound(const VEC *vec, const void *val, cmp_func_t compare)
+{
+    size_t lo = 0, hi;
+
+    assert(vec && compare);
 
-    // 在行尾插入
-    if (index >= (int)vec_size(vec)) {
-        for (size_t i = 0; i < vec_size(insert_vec); i++) {
-            vec_push_back(vec, vec_get((VEC*)insert_vec, i));
+    hi = vec_size(vec);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((*compare)((char*)vec->beg + mid * vec->unit_size, val) > 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
         }
-    } else {
-        // 先向后移动原来的元素
-        for (int i = vec_size(vec) - 1; i >= index; i--) {
-            __vec_put(vec, i + vec_size(insert_vec), vec_get(vec, i));
-        } 
+    }
+    return lo;
+}
+
+size_t vec_unique(VEC *vec, cmp_func_t compare)
+{
+    size_t unit, len, write = 1;
+    char *beg;
+
+    assert(vec && compare);
+
+    len = vec_size(vec);
+    if (len < 2) return 0;
 
-        // 插入新的元素
-        for (size_t i = 0; i < vec_size(insert_vec); i++) {
-            __vec_put(vec, i + index, vec_get((VEC*)insert_vec, i));
+    unit = vec->unit_size;
+    beg = (char*)vec->beg;
+    for (size_t i = 1; i < len; i++) {
+        char *elem = beg + i * unit;
+        if (0 == (*compare)(beg + (write - 1) * unit, elem)) {
+            if (vec->destroy_func) {
+                (*vec->destroy_func)(elem);
+            }
+        } else {
+            if (write != i) {
+                memcpy(beg + write * unit, elem, unit);
+            }
+            ++ write;
+        }
+    }
+
+    vec->len = write;
+    return len - write;
+}
+
+// 集合操作的种类
+typedef enum {
+    SET_OP_MERGE,
+    SET_OP_UNION,
+    SET_OP_INTERSECTION,
+    SET_OP_DIFFERENCE,
+} __set_op_t;
+
+// 所有集合操作共用的归并过程，结果追加到dst的尾部
+static void
+__vec_set_op(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare, __set_op_t op)
+{
+    size_t unit, na, nb, i = 0, j = 0, max_count;
+    const char *pa, *pb;
+    char *out;
+
+    assert(dst && a && b && compare);
+    assert(dst != a && dst != b);
+    assert(dst->unit_size == a->unit_size && dst->unit_size == b->unit_size);
+
+    unit = dst->unit_size;
+    na = vec_size(a);
+    nb = vec_size(b);
+    pa = (const char*)a->beg;
+    pb = (const char*)b->beg;
+
+    switch (op) {
+        case SET_OP_INTERSECTION: max_count = CSTL_MIN(na, nb); break;
+        case SET_OP_DIFFERENCE: max_count = na; break;
+        default: max_count = na + nb; break;
+    }
+    vec_reserve(dst, vec_size(dst) + max_count);
+    out = (char*)dst->beg + vec_size(dst) * unit;
+
+    while (i < na && j < nb) {
+        const char *ea = pa + i * unit, *eb = pb + j * unit;
+        const char *emit = NULL;
+        int rs = (*compare)(ea, eb);
+
+        if (rs < 0) {
+            // a中的更小
+            if (op != SET_OP_INTERSECTION) emit = ea;
+            ++ i;
+        } else if (rs > 0) {
+            // b中的更小
+            if (op == SET_OP_MERGE || op == SET_OP_UNION) emit = eb;
+            ++ j;
+        } else if (op == SET_OP_MERGE) {
+            // 相等时候先取a中的，b中的留到后面，保证归并是稳定的
+            emit = ea;
+            ++ i;
+        } else {
+            if (op != SET_OP_DIFFERENCE) emit = ea;
+            ++ i;
+            ++ j;
+        }
+
+        if (emit != NULL) {
+            memcpy(out, emit, unit);
+            out += unit;
         }
+    }
 
-        // 更新元素长度
-        vec->len += vec_size(insert_vec);
+    // 剩下的部分整体复制
+    if (op != SET_OP_INTERSECTION) {
+        memcpy(out, pa + i * unit, (na - i) * unit);
+        out += (na - i) * unit;
     }
+    if (op == SET_OP_MERGE || op == SET_OP_UNION) {
+        memcpy(out, pb + j * unit, (nb - j) * unit);
+        out += (nb - j) * unit;
+    }
+
+    dst->len = (out - (char*)dst->beg) / unit;
 }
 
-void vec_extend_front(VEC *vec, const VEC *insert_vec)
+void vec_merge_sorted(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare)
 {
-    vec_extend(vec, 0, insert_vec);
+    __vec_set_op(dst, a, b, compare, SET_OP_MERGE);
 }
 
-void vec_extend_back(VEC *vec, const VEC *insert_vec)
+void vec_set_union(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare)
 {
-    vec_extend(vec, vec_size(vec), insert_vec);
+    __vec_set_op(dst, a, b, compare, SET_OP_UNION);
+}
+
+void vec_set_intersection(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare)
+{
+    __vec_set_op(dst, a, b, compare, SET_OP_INTERSECTION);
+}
+
+void vec_set_difference(VEC *dst, const VEC *a, const VEC *b, cmp_func_t compare)
+{
+    __vec_set_op(dst, a, b, compare, SET_OP_DIFFERENCE);
 }
 
 static inline void
@@ -371,88 +778,1424 @@ void vec_swap(VEC *vec, size_t idx1, size_t idx2)
     __vec_swap(vec, idx1, idx2);
 }
 
-static void
-__vec_get_copy(VEC *vec, int index, void *ret)
+// 排序使用的是pattern-defeating quicksort(pdqsort)：
+// - 小区间使用插入排序
+// - 使用三数取中(大区间使用ninther)来选择枢轴，有序和逆序的输入不会退化
+// - 划分时候没有发生交换的话，尝试使用有限次数的插入排序直接完成排序，对于近似有序的输入是O(n)
+// - 出现大量相等元素时候，将等于枢轴的元素一次性划分出去
+// - 划分极不平衡的次数超过log2(n)时候，改用堆排序，保证最坏情况是O(n log n)
+// - 只对较小的一侧递归，较大的一侧使用循环，递归深度最多是O(log n)
+
+#define SORT_INSERTION_THRESHOLD 24         // 小于这个数目的区间使用插入排序
+#define SORT_NINTHER_THRESHOLD 128          // 大于这个数目的区间使用ninther选择枢轴
+#define SORT_PARTIAL_INSERTION_LIMIT 8      // 尝试插入排序时最多允许移动的元素数目
+
+typedef struct {
+    char *base;         // 第一个元素的地址
+    size_t unit;        // 单个元素的尺寸
+    cmp_func_t cmp;
+    char *tmp;          // 交换元素时使用的缓冲区
+    char *pivot;        // 保存枢轴的缓冲区
+} __sort_ctx_t;
+
+#define ELEM(ctx, i) ((ctx)->base + (size_t)(i) * (ctx)->unit)
+
+static inline bool
+__sort_less(__sort_ctx_t *ctx, size_t i, size_t j)
 {
-    void *value = vec_get(vec, index);
-    memmove(ret, value, vec->unit_size);
+    return (*ctx->cmp)(ELEM(ctx, i), ELEM(ctx, j)) < 0;
 }
 
-// 返回的索引，可以保证索引左侧的值都比pivo_value小，右侧的值都是pivot_value大
-static int
-__vec_partition(VEC *vec, int left, int right, cmp_func_t compare)
+static inline void
+__sort_swap(__sort_ctx_t *ctx, size_t i, size_t j)
 {
-    char pivot[vec->unit_size];
-    int i = left;
-    int j = right;
-    __vec_get_copy(vec, left, pivot);
+    memcpy(ctx->tmp, ELEM(ctx, i), ctx->unit);
+    memcpy(ELEM(ctx, i), ELEM(ctx, j), ctx->unit);
+    memcpy(ELEM(ctx, j), ctx->tmp, ctx->unit);
+}
 
-    while (i < j) {
+static inline void
+__sort2(__sort_ctx_t *ctx, size_t i, size_t j)
+{
+    if (__sort_less(ctx, j, i)) __sort_swap(ctx, i, j);
+}
 
-        // 从右向左左，找第一个比pivot小或相等的数
-        while (i < j && (*compare)(vec_get(vec, j), pivot) > 0)
-            j--;
-        if (i < j) {
-            __vec_put(vec, i, vec_get(vec, j));
-            i++;
-        }
+static inline void
+__sort3(__sort_ctx_t *ctx, size_t i, size_t j, size_t k)
+{
+    __sort2(ctx, i, j);
+    __sort2(ctx, j, k);
+    __sort2(ctx, i, j);
+}
 
+// 将元素i插入到[begin, i)这个有序区间中，返回移动的元素数目
+static inline size_t
+__sort_insert_one(__sort_ctx_t *ctx, size_t begin, size_t i)
+{
+    size_t j = i - 1;
 
-        // 从左向右找，第一个比pivot大或者相等的数
-        while (i < j && (*compare)(vec_get(vec, i), pivot) < 0) {
-            i++;
-        }
+    if (!__sort_less(ctx, i, j)) return 0;
 
-        if (i < j) {
-            __vec_put(vec, j, vec_get(vec, i));
-            j--;
-        }
+    memcpy(ctx->tmp, ELEM(ctx, i), ctx->unit);
+    while (j > begin && (*ctx->cmp)(ctx->tmp, ELEM(ctx, j - 1)) < 0) {
+        j--;
     }
-
-    __vec_put(vec, i, pivot);
-    return i;
+    // 一次性挪移，不用逐个元素复制
+    memmove(ELEM(ctx, j + 1), ELEM(ctx, j), (i - j) * ctx->unit);
+    memcpy(ELEM(ctx, j), ctx->tmp, ctx->unit);
+    return i - j;
 }
 
-//1 2 3 4 5
-//    ^
+// 对[begin, end)进行插入排序
 static void
-__vec_quick_sort(VEC *vec, int left, int right, cmp_func_t compare)
+__insertion_sort(__sort_ctx_t *ctx, size_t begin, size_t end)
+{
+    for (size_t i = begin + 1; i < end; i++) {
+        __sort_insert_one(ctx, begin, i);
+    }
+}
+
+// 尝试使用插入排序对[begin, end)进行排序，如果移动的元素太多则放弃，返回是否排序完成
+static bool
+__partial_insertion_sort(__sort_ctx_t *ctx, size_t begin, size_t end)
 {
-    int pivot_index;
+    size_t moved = 0;
 
-    if (left < right) {
-        pivot_index = __vec_partition(vec, left, right, compare);
-        __vec_quick_sort(vec, left, pivot_index - 1, compare);
-        __vec_quick_sort(vec, pivot_index + 1, right, compare);
+    for (size_t i = begin + 1; i < end; i++) {
+        moved += __sort_insert_one(ctx, begin, i);
+        if (moved > SORT_PARTIAL_INSERTION_LIMIT) return false;
     }
+    return true;
 }
 
-void vec_sort(VEC *vec, cmp_func_t compare)
+static void
+__sift_down(__sort_ctx_t *ctx, size_t begin, size_t root, size_t n)
 {
-    __vec_quick_sort(vec, 0, vec_size(vec) - 1, compare);
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= n) break;
+        if (child + 1 < n && __sort_less(ctx, begin + child, begin + child + 1)) child++;
+        if (!__sort_less(ctx, begin + root, begin + child)) break;
+        __sort_swap(ctx, begin + root, begin + child);
+        root = child;
+    }
 }
 
-void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *user_data)
+static void
+__heap_sort(__sort_ctx_t *ctx, size_t begin, size_t end)
 {
-    assert(vec && "vec can't be null!");
-    assert(vec_foreach_func && "foreach callback can't be null!");
+    size_t n = end - begin;
 
-    for (size_t i = 0; i < vec_size(vec); i++) {
-        (*vec_foreach_func)(vec_get(vec, i), user_data);
+    for (size_t i = n / 2; i-- > 0;) {
+        __sift_down(ctx, begin, i, n);
+    }
+    for (size_t i = n - 1; i > 0; i--) {
+        __sort_swap(ctx, begin, begin + i);
+        __sift_down(ctx, begin, 0, i);
     }
 }
 
-void vec_free(VEC *vec)
+// 以begin位置上的元素为枢轴进行划分，左侧的元素都小于枢轴，右侧的元素都大于等于枢轴，
+// 返回枢轴最终的位置，*already_partitioned表示划分前是否就已经是划分好的
+static size_t
+__partition_right(__sort_ctx_t *ctx, size_t begin, size_t end, bool *already_partitioned)
 {
-    assert(vec);
+    size_t first = begin, last = end, pivot_pos;
+    cmp_func_t cmp = ctx->cmp;
+    char *pivot = ctx->pivot;
 
-    // 调用析构函数
-    if (vec->destroy_func != NULL) {
-        for (size_t i = 0; i < vec_size(vec); i++) {
-            (*vec->destroy_func)((char*)vec->beg + (i * vec->unit_size));
-        }
+    memcpy(pivot, ELEM(ctx, begin), ctx->unit);
+
+    // 找到第一个大于等于枢轴的元素，和最后一个小于枢轴的元素
+    while (++first < end && (*cmp)(ELEM(ctx, first), pivot) < 0);
+    while (first < last && !((*cmp)(ELEM(ctx, --last), pivot) < 0));
+
+    *already_partitioned = first >= last;
+
+    while (first < last) {
+        __sort_swap(ctx, first, last);
+        while (++first < end && (*cmp)(ELEM(ctx, first), pivot) < 0);
+        while (--last > begin && !((*cmp)(ELEM(ctx, last), pivot) < 0));
+    }
+
+    pivot_pos = first - 1;
+    memcpy(ELEM(ctx, begin), ELEM(ctx, pivot_pos), ctx->unit);
+    memcpy(ELEM(ctx, pivot_pos), pivot, ctx->unit);
+    return pivot_pos;
+}
+
+// 和__partition_right相似，但是等于枢轴的元素都放在左侧，
+// 用于枢轴和左侧区间的元素相等的情况，此时左侧的元素都已经在最终位置上
+static size_t
+__partition_left(__sort_ctx_t *ctx, size_t begin, size_t end)
+{
+    size_t first = begin, last = end;
+    cmp_func_t cmp = ctx->cmp;
+    char *pivot = ctx->pivot;
+
+    memcpy(pivot, ELEM(ctx, begin), ctx->unit);
+
+    while (--last > begin && (*cmp)(pivot, ELEM(ctx, last)) < 0);
+    while (first < last && !((*cmp)(pivot, ELEM(ctx, ++first)) < 0));
+
+    while (first < last) {
+        __sort_swap(ctx, first, last);
+        while (--last > begin && (*cmp)(pivot, ELEM(ctx, last)) < 0);
+        while (++first < end && !((*cmp)(pivot, ELEM(ctx, first)) < 0));
     }
 
-    __free(vec->beg);
+    memcpy(ELEM(ctx, begin), ELEM(ctx, last), ctx->unit);
+    memcpy(ELEM(ctx, last), pivot, ctx->unit);
+    return last;
+}
+
+// 选择[begin, end)的枢轴并放到begin位置上，大区间使用ninther
+static inline void
+__choose_pivot(__sort_ctx_t *ctx, size_t begin, size_t end)
+{
+    size_t size = end - begin;
+    size_t s2 = size / 2;
+
+    if (size > SORT_NINTHER_THRESHOLD) {
+        __sort3(ctx, begin, begin + s2, end - 1);
+        __sort3(ctx, begin + 1, begin + s2 - 1, end - 2);
+        __sort3(ctx, begin + 2, begin + s2 + 1, end - 3);
+        __sort3(ctx, begin + s2 - 1, begin + s2, begin + s2 + 1);
+        __sort_swap(ctx, begin, begin + s2);
+    } else {
+        __sort3(ctx, begin + s2, begin, end - 1);
+    }
+}
+
+// 划分极不平衡之后，打乱枢轴两侧的一些元素，破坏掉导致不平衡的模式
+static void
+__break_patterns(__sort_ctx_t *ctx, size_t begin, size_t pivot_pos, size_t end)
+{
+    size_t l_size = pivot_pos - begin;
+    size_t r_size = end - (pivot_pos + 1);
+
+    if (l_size >= SORT_INSERTION_THRESHOLD) {
+        __sort_swap(ctx, begin, begin + l_size / 4);
+        __sort_swap(ctx, pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > SORT_NINTHER_THRESHOLD) {
+            __sort_swap(ctx, begin + 1, begin + (l_size / 4 + 1));
+            __sort_swap(ctx, begin + 2, begin + (l_size / 4 + 2));
+            __sort_swap(ctx, pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+            __sort_swap(ctx, pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+    }
+    if (r_size >= SORT_INSERTION_THRESHOLD) {
+        __sort_swap(ctx, pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        __sort_swap(ctx, end - 1, end - r_size / 4);
+        if (r_size > SORT_NINTHER_THRESHOLD) {
+            __sort_swap(ctx, pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+            __sort_swap(ctx, pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+            __sort_swap(ctx, end - 2, end - (1 + r_size / 4));
+            __sort_swap(ctx, end - 3, end - (2 + r_size / 4));
+        }
+    }
+}
+
+// 对[begin, end)进行排序，bad_allowed表示还允许出现多少次极不平衡的划分，
+// leftmost表示begin左侧是否没有元素(不是最左侧的区间，左侧的元素都小于等于区间内所有的元素)
+static void
+__pdq_sort(__sort_ctx_t *ctx, size_t begin, size_t end, int bad_allowed, bool leftmost)
+{
+    for (;;) {
+        size_t size = end - begin;
+        size_t pivot_pos, l_size, r_size;
+        bool already_partitioned;
+
+        if (size < SORT_INSERTION_THRESHOLD) {
+            __insertion_sort(ctx, begin, end);
+            return;
+        }
+
+        __choose_pivot(ctx, begin, end);
+
+        // 左侧相邻的元素不小于枢轴，说明枢轴和它相等，将所有相等的元素一次性划分出去
+        if (!leftmost && !__sort_less(ctx, begin - 1, begin)) {
+            begin = __partition_left(ctx, begin, end) + 1;
+            continue;
+        }
+
+        pivot_pos = __partition_right(ctx, begin, end, &already_partitioned);
+        l_size = pivot_pos - begin;
+        r_size = end - (pivot_pos + 1);
+
+        if (l_size < size / 8 || r_size < size / 8) {
+            // 极不平衡的划分，次数太多就改用堆排序
+            if (--bad_allowed == 0) {
+                __heap_sort(ctx, begin, end);
+                return;
+            }
+
+            __break_patterns(ctx, begin, pivot_pos, end);
+        } else if (already_partitioned
+                && __partial_insertion_sort(ctx, begin, pivot_pos)
+                && __partial_insertion_sort(ctx, pivot_pos + 1, end)) {
+            // 划分前就已经是有序的，插入排序很快就完成了
+            return;
+        }
+
+        // 较小的一侧递归，较大的一侧继续循环
+        if (l_size < r_size) {
+            __pdq_sort(ctx, begin, pivot_pos, bad_allowed, leftmost);
+            begin = pivot_pos + 1;
+            leftmost = false;
+        } else {
+            __pdq_sort(ctx, pivot_pos + 1, end, bad_allowed, false);
+            end = pivot_pos;
+        }
+    }
+}
+
+// 选择(introselect)：重新排列[begin, end)，使得k位置上的元素就是排序之后这个位置上的元素，
+// 它左侧的元素都不大于它，右侧的元素都不小于它。
+// 枢轴选择和划分和pdqsort相同，但是每次只继续处理包含k的一侧，平均是O(n)，
+// 极不平衡的划分太多时候，对剩余的区间使用堆排序，保证最坏情况是O(n log n)
+static void
+__introselect(__sort_ctx_t *ctx, size_t begin, size_t end, size_t k, int bad_allowed)
+{
+    bool leftmost = true;
+
+    for (;;) {
+        size_t size = end - begin;
+        size_t pivot_pos;
+        bool already_partitioned;
+
+        if (size < SORT_INSERTION_THRESHOLD) {
+            __insertion_sort(ctx, begin, end);
+            return;
+        }
+
+        __choose_pivot(ctx, begin, end);
+
+        // 枢轴和左侧相邻的元素相等，等于枢轴的元素都已经在最终位置上
+        if (!leftmost && !__sort_less(ctx, begin - 1, begin)) {
+            pivot_pos = __partition_left(ctx, begin, end);
+            if (k <= pivot_pos) return;
+            begin = pivot_pos + 1;
+            continue;
+        }
+
+        pivot_pos = __partition_right(ctx, begin, end, &already_partitioned);
+        if (pivot_pos == k) return;
+
+        if (pivot_pos - begin < size / 8 || end - (pivot_pos + 1) < size / 8) {
+            if (--bad_allowed == 0) {
+                __heap_sort(ctx, begin, end);
+                return;
+            }
+            __break_patterns(ctx, begin, pivot_pos, end);
+        }
+
+        if (k < pivot_pos) {
+            end = pivot_pos;
+        } else {
+            begin = pivot_pos + 1;
+            leftmost = false;
+        }
+    }
+}
+
+#undef ELEM
+
+static inline int
+__log2_size(size_t n)
+{
+    int log2_n = 0;
+
+    while ((n >> log2_n) > 1) {
+        ++ log2_n;
+    }
+    return log2_n;
+}
+
+void vec_sort(VEC *vec, cmp_func_t compare)
+{
+    size_t n;
+
+    assert(vec && compare);
+
+    n = vec_size(vec);
+    if (n < 2) return;
+
+    char tmp[vec->unit_size];
+    char pivot[vec->unit_size];
+    __sort_ctx_t ctx = {
+        .base = (char*)vec->beg,
+        .unit = vec->unit_size,
+        .cmp = compare,
+        .tmp = tmp,
+        .pivot = pivot
+    };
+
+    __pdq_sort(&ctx, 0, n, __log2_size(n), true);
+}
+
+void vec_nth_element(VEC *vec, size_t k, cmp_func_t compare)
+{
+    size_t n;
+
+    assert(vec && compare);
+
+    n = vec_size(vec);
+    if (k >= n || n < 2) return;
+
+    char tmp[vec->unit_size];
+    char pivot[vec->unit_size];
+    __sort_ctx_t ctx = {
+        .base = (char*)vec->beg,
+        .unit = vec->unit_size,
+        .cmp = compare,
+        .tmp = tmp,
+        .pivot = pivot
+    };
+
+    __introselect(&ctx, 0, n, k, __log2_size(n));
+}
+
+void vec_partial_sort(VEC *vec, size_t k, cmp_func_t compare)
+{
+    size_t n;
+
+    assert(vec && compare);
+
+    n = vec_size(vec);
+    if (k >= n) {
+        vec_sort(vec, compare);
+        return;
+    }
+    if (k == 0) return;
+
+    char tmp[vec->unit_size];
+    char pivot[vec->unit_size];
+    __sort_ctx_t ctx = {
+        .base = (char*)vec->beg,
+        .unit = vec->unit_size,
+        .cmp = compare,
+        .tmp = tmp,
+        .pivot = pivot
+    };
+
+    // 先选出第k-1个元素，此时它左侧就是最小的k-1个元素，只需要再对它们排序
+    __introselect(&ctx, 0, n, k - 1, __log2_size(n));
+    __pdq_sort(&ctx, 0, k - 1, __log2_size(k), true);
+}
+
+void vec_top_k(VEC *dst, const VEC *src, size_t k, cmp_func_t compare)
+{
+    size_t n, old_size;
+    const char *elem;
+
+    assert(dst && src && compare && dst != src);
+    assert(dst->unit_size == src->unit_size);
+
+    n = vec_size(src);
+    if (k > n) k = n;
+    if (k == 0) return;
+
+    // 前k个元素放到dst的尾部建立最大堆，堆顶是目前选中的元素中最大的那个，
+    // 之后只有比堆顶小的元素才需要替换堆顶，src不会被修改，额外空间只有k个元素
+    old_size = vec_size(dst);
+    vec_append_array(dst, src->beg, k);
+
+    char tmp[dst->unit_size];
+    __sort_ctx_t ctx = {
+        .base = (char*)dst->beg + old_size * dst->unit_size,
+        .unit = dst->unit_size,
+        .cmp = compare,
+        .tmp = tmp,
+        .pivot = NULL
+    };
+
+    for (size_t i = k / 2; i-- > 0;) {
+        __sift_down(&ctx, 0, i, k);
+    }
+    for (size_t i = k; i < n; i++) {
+        elem = (const char*)src->beg + i * src->unit_size;
+        if ((*compare)(elem, ctx.base) < 0) {
+            memcpy(ctx.base, elem, ctx.unit);
+            __sift_down(&ctx, 0, 0, k);
+        }
+    }
+
+    // 堆排序的第二个阶段，结果是升序的
+    for (size_t i = k - 1; i > 0; i--) {
+        __sort_swap(&ctx, 0, i);
+        __sift_down(&ctx, 0, 0, i);
+    }
+}
+
+// 并行排序：
+// - 将数组平均分成nthreads块，每个线程使用pdqsort排序自己的块
+// - 然后逐轮两两归并相邻的有序块(在原数组和缓冲区之间来回)，每一对的输出按照线程数目切分成多段，
+//   通过在两个有序块上二分查找(merge path)找到每段对应的输入，这样每一轮所有线程都能参与
+// - 每个阶段由主线程和nthreads-1个工作线程共同完成，阶段结束时等待所有工作线程
+
+#define PARALLEL_SORT_MIN_PER_THREAD 16384  // 每个线程至少要处理的元素数目，否则直接使用vec_sort
+
+typedef struct {
+    const char *a;      // 第一个有序区间
+    size_t na;
+    const char *b;      // 第二个有序区间
+    size_t nb;
+    char *out;          // 归并结果的起始位置
+    size_t k_beg;       // 这个任务负责输出的区间[k_beg, k_end)
+    size_t k_end;
+} __merge_task_t;
+
+typedef struct {
+    char *base;
+    size_t unit;
+    cmp_func_t cmp;
+    size_t n;
+    int nthreads;
+    bool local_sort;        // 当前阶段是否是各个块的局部排序
+    __merge_task_t *tasks;
+    size_t task_count;
+} __par_sort_t;
+
+typedef struct {
+    __par_sort_t *shared;
+    int index;
+} __par_worker_t;
+
+// 返回归并之后的前k个元素中，有多少个来自于a(相等的元素a在前)
+static size_t
+__merge_corank(const __par_sort_t *ps, const __merge_task_t *task, size_t k)
+{
+    size_t lo = k > task->nb ? k - task->nb : 0;
+    size_t hi = CSTL_MIN(k, task->na);
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (!((*ps->cmp)(task->b + (k - mid - 1) * ps->unit, task->a + mid * ps->unit) < 0)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void
+__merge_task_run(const __par_sort_t *ps, const __merge_task_t *task)
+{
+    size_t unit = ps->unit;
+    size_t i = __merge_corank(ps, task, task->k_beg), j = task->k_beg - i;
+    size_t i_end = __merge_corank(ps, task, task->k_end), j_end = task->k_end - i_end;
+    char *out = task->out + task->k_beg * unit;
+
+    while (i < i_end && j < j_end) {
+        if ((*ps->cmp)(task->b + j * unit, task->a + i * unit) < 0) {
+            memcpy(out, task->b + (j++) * unit, unit);
+        } else {
+            memcpy(out, task->a + (i++) * unit, unit);
+        }
+        out += unit;
+    }
+    memcpy(out, task->a + i * unit, (i_end - i) * unit);
+    out += (i_end - i) * unit;
+    memcpy(out, task->b + j * unit, (j_end - j) * unit);
+}
+
+static void *
+__par_sort_worker(void *arg)
+{
+    __par_worker_t *worker = (__par_worker_t *)arg;
+    __par_sort_t *ps = worker->shared;
+
+    if (ps->local_sort) {
+        size_t beg = ps->n * worker->index / ps->nthreads;
+        size_t end = ps->n * (worker->index + 1) / ps->nthreads;
+        size_t count = end - beg;
+        char tmp[ps->unit];
+        char pivot[ps->unit];
+        __sort_ctx_t ctx = {
+            .base = ps->base + beg * ps->unit,
+            .unit = ps->unit,
+            .cmp = ps->cmp,
+            .tmp = tmp,
+            .pivot = pivot
+        };
+
+        if (count > 1) __pdq_sort(&ctx, 0, count, __log2_size(count), true);
+    } else {
+        for (size_t t = worker->index; t < ps->task_count; t += ps->nthreads) {
+            __merge_task_run(ps, &ps->tasks[t]);
+        }
+    }
+    return NULL;
+}
+
+// 在调用线程和nthreads-1个工作线程上运行worker，第i个线程的参数是args + i * arg_size，
+// 等待所有工作线程结束之后返回，工作线程创建失败时候由调用线程代为完成
+static void
+__par_run_workers(int nthreads, void *(*worker)(void *), void *args, size_t arg_size)
+{
+    pthread_t *threads = (pthread_t *)cstl_malloc(nthreads * sizeof(pthread_t));
+    bool *started = (bool *)cstl_malloc(nthreads * sizeof(bool));
+
+    for (int i = 1; i < nthreads; i++) {
+        started[i] = (pthread_create(&threads[i], NULL, worker, (char *)args + i * arg_size) == 0);
+    }
+    (*worker)(args);
+    for (int i = 1; i < nthreads; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            (*worker)((char *)args + i * arg_size);
+        }
+    }
+    cstl_free(started);
+    cstl_free(threads);
+}
+
+// nthreads为0的时候返回cpu核心的数目
+static int
+__par_thread_count(int nthreads)
+{
+    if (nthreads == 0) {
+#if defined(_SC_NPROCESSORS_ONLN)
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if (nthreads < 1) nthreads = 1;
+    }
+    return nthreads;
+}
+
+void vec_sort_parallel(VEC *vec, cmp_func_t compare, int nthreads)
+{
+    __par_sort_t ps;
+    size_t n, run_count, *runs, unit;
+    __par_worker_t *workers;
+    char *src, *dst, *buf;
+
+    assert(vec && compare && nthreads >= 0);
+
+    n = vec_size(vec);
+    nthreads = (int)CSTL_MIN((size_t)__par_thread_count(nthreads), n / PARALLEL_SORT_MIN_PER_THREAD);
+    if (nthreads <= 1) {
+        vec_sort(vec, compare);
+        return;
+    }
+
+    unit = vec->unit_size;
+    ps.base = (char *)vec->beg;
+    ps.unit = unit;
+    ps.cmp = compare;
+    ps.n = n;
+    ps.nthreads = nthreads;
+    ps.local_sort = true;
+    ps.tasks = NULL;
+    ps.task_count = 0;
+
+    workers = (__par_worker_t *)cstl_malloc(nthreads * sizeof(__par_worker_t));
+    for (int i = 0; i < nthreads; i++) {
+        workers[i].shared = &ps;
+        workers[i].index = i;
+    }
+
+    // 第一阶段：各个块的局部排序
+    __par_run_workers(nthreads, __par_sort_worker, workers, sizeof(__par_worker_t));
+
+    // runs[i]是第i个有序块的起始位置，runs[run_count] == n
+    runs = (size_t *)cstl_malloc((nthreads + 1) * sizeof(size_t));
+    for (int i = 0; i <= nthreads; i++) {
+        runs[i] = n * i / nthreads;
+    }
+    run_count = nthreads;
+
+    buf = (char *)cstl_malloc(n * unit);
+    ps.tasks = (__merge_task_t *)cstl_malloc(2 * nthreads * sizeof(__merge_task_t));
+    ps.local_sort = false;
+    src = ps.base;
+    dst = buf;
+
+    // 逐轮归并，直到只剩下一个有序块；如果结果在缓冲区中，最后再并行复制回来
+    while (run_count > 1 || src != ps.base) {
+        size_t pair_count = (run_count + 1) / 2;
+
+        ps.task_count = 0;
+        for (size_t p = 0; p < pair_count; p++) {
+            size_t beg = runs[2 * p];
+            size_t mid = runs[CSTL_MIN(2 * p + 1, run_count)];
+            size_t end = runs[CSTL_MIN(2 * p + 2, run_count)];
+            size_t len = end - beg;
+            size_t pieces = CSTL_MAX((size_t)1, (size_t)nthreads * len / n);
+
+            // 只剩一块时，归并退化为复制
+            if (run_count == 1) pieces = nthreads;
+
+            for (size_t k = 0; k < pieces; k++) {
+                __merge_task_t *task = &ps.tasks[ps.task_count++];
+                task->a = src + beg * unit;
+                task->na = mid - beg;
+                task->b = src + mid * unit;
+                task->nb = end - mid;
+                task->out = dst + beg * unit;
+                task->k_beg = len * k / pieces;
+                task->k_end = len * (k + 1) / pieces;
+            }
+        }
+        __par_run_workers(nthreads, __par_sort_worker, workers, sizeof(__par_worker_t));
+
+        for (size_t p = 0; p < pair_count; p++) {
+            runs[p] = runs[2 * p];
+        }
+        runs[pair_count] = n;
+        run_count = pair_count;
+
+        char *tmp = src; src = dst; dst = tmp;
+    }
+
+    cstl_free(ps.tasks);
+    cstl_free(buf);
+    cstl_free(runs);
+    cstl_free(workers);
+}
+
+// 并行遍历和归约：
+// - 将元素分成若干个连续的块，每个线程开始的时候分到相邻的一段块
+// - 线程从自己那一段的前面依次取块处理，处理完之后从其他线程那一段的后面偷走一半，
+//   这样回调函数的耗时不均匀的时候，先完成的线程可以分担其他线程剩下的工作
+// - 每个线程的那一段使用一个64位的字保存[next, end)，取块和偷块都只需要一次CAS
+// - 归约时候每个块有自己的部分结果，最后在调用线程中按照块的顺序合并
+
+#define PARALLEL_CHUNKS_PER_THREAD 8        // 每个线程平均分到的块数，越多负载越均衡，但是竞争也越多
+#define PARALLEL_MIN_CHUNK 1024             // 每个块至少包含的元素数目
+#define PARALLEL_MAX_CHUNKS 0xffffffffu     // 块的索引需要能够放到32位中
+
+#define CHUNK_RANGE(next, end) (((uint64_t)(end) << 32) | (uint64_t)(next))
+#define CHUNK_NEXT(range) ((size_t)((range) & 0xffffffffu))
+#define CHUNK_END(range) ((size_t)((range) >> 32))
+
+typedef struct {
+    uint64_t range;                         // 还没有处理的块[next, end)
+    char pad[64 - sizeof(uint64_t)];        // 每个线程的范围位于不同的缓存行中
+} __chunk_queue_t;
+
+typedef struct {
+    char *base;
+    size_t unit;
+    size_t n;
+    size_t chunk_count;
+    int nthreads;
+    __chunk_queue_t *queues;
+    vec_foreach_func_t foreach_func;        // 遍历时候使用
+    vec_map_func_t map_func;                // 归约时候使用，不为NULL的时候忽略foreach_func
+    char *accs;                             // 每个块的部分结果
+    size_t acc_size;
+    void *user_data;
+} __par_for_t;
+
+typedef struct {
+    __par_for_t *shared;
+    int index;
+} __par_for_worker_t;
+
+static void
+__par_for_init(__par_for_t *pf, const VEC *vec, void *user_data, int nthreads)
+{
+    size_t chunk_count;
+
+    pf->base = (char *)vec->beg;
+    pf->unit = vec->unit_size;
+    pf->n = vec_size(vec);
+    pf->nthreads = __par_thread_count(nthreads);
+
+    chunk_count = CSTL_MIN((size_t)pf->nthreads * PARALLEL_CHUNKS_PER_THREAD, pf->n / PARALLEL_MIN_CHUNK);
+    pf->chunk_count = CSTL_MAX((size_t)1, CSTL_MIN(chunk_count, (size_t)PARALLEL_MAX_CHUNKS));
+    pf->nthreads = (int)CSTL_MIN((size_t)pf->nthreads, pf->chunk_count);
+    // 只有一个线程的时候也只使用一个块，和串行的循环完全相同
+    if (pf->nthreads <= 1) pf->chunk_count = 1;
+
+    pf->queues = NULL;
+    pf->foreach_func = NULL;
+    pf->map_func = NULL;
+    pf->accs = NULL;
+    pf->acc_size = 0;
+    pf->user_data = user_data;
+}
+
+static void
+__par_for_run_chunk(const __par_for_t *pf, size_t chunk)
+{
+    size_t beg = pf->n * chunk / pf->chunk_count;
+    size_t end = pf->n * (chunk + 1) / pf->chunk_count;
+    char *elem = pf->base + beg * pf->unit;
+
+    if (pf->map_func) {
+        char *acc = pf->accs + chunk * pf->acc_size;
+        for (size_t i = beg; i < end; i++, elem += pf->unit) {
+            (*pf->map_func)(acc, elem, pf->user_data);
+        }
+    } else {
+        for (size_t i = beg; i < end; i++, elem += pf->unit) {
+            (*pf->foreach_func)(elem, pf->user_data);
+        }
+    }
+}
+
+// 从自己的范围的前面取一个块
+static bool
+__chunk_take(__chunk_queue_t *queue, size_t *chunk)
+{
+    uint64_t range = __atomic_load_n(&queue->range, __ATOMIC_RELAXED);
+
+    while (CHUNK_NEXT(range) < CHUNK_END(range)) {
+        // 失败的时候range会被更新为最新的值
+        if (__atomic_compare_exchange_n(&queue->range, &range,
+                    CHUNK_RANGE(CHUNK_NEXT(range) + 1, CHUNK_END(range)), true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            *chunk = CHUNK_NEXT(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 从其他线程的范围的后面偷走一半的块(至少一个)，结果是[*beg, *end)
+static bool
+__chunk_steal(__chunk_queue_t *victim, size_t *beg, size_t *end)
+{
+    uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_RELAXED);
+
+    while (CHUNK_NEXT(range) < CHUNK_END(range)) {
+        size_t half = (CHUNK_END(range) - CHUNK_NEXT(range) + 1) / 2;
+        if (__atomic_compare_exchange_n(&victim->range, &range,
+                    CHUNK_RANGE(CHUNK_NEXT(range), CHUNK_END(range) - half), true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            *beg = CHUNK_END(range) - half;
+            *end = CHUNK_END(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 每个块只会出现在一个线程的范围中，并且只会被取走一次，所以范围的值不会重复出现，CAS没有ABA问题。
+// 块只是元素的索引，元素本身的访问由pthread_join同步，所以使用relaxed就足够了
+static void *
+__par_for_worker(void *arg)
+{
+    __par_for_worker_t *worker = (__par_for_worker_t *)arg;
+    __par_for_t *pf = worker->shared;
+    __chunk_queue_t *own = &pf->queues[worker->index];
+    size_t chunk, beg, end;
+
+    for (;;) {
+        bool stolen = false;
+
+        while (__chunk_take(own, &chunk)) {
+            __par_for_run_chunk(pf, chunk);
+        }
+        // 自己的块处理完了，从下一个线程开始依次尝试，所有的范围都为空的时候结束
+        for (int k = 1; k < pf->nthreads && !stolen; k++) {
+            stolen = __chunk_steal(&pf->queues[(worker->index + k) % pf->nthreads], &beg, &end);
+        }
+        if (!stolen) break;
+        __atomic_store_n(&own->range, CHUNK_RANGE(beg, end), __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static void
+__par_for_run(__par_for_t *pf)
+{
+    __par_for_worker_t *workers;
+
+    pf->queues = (__chunk_queue_t *)cstl_malloc(pf->nthreads * sizeof(__chunk_queue_t));
+    workers = (__par_for_worker_t *)cstl_malloc(pf->nthreads * sizeof(__par_for_worker_t));
+    for (int i = 0; i < pf->nthreads; i++) {
+        pf->queues[i].range = CHUNK_RANGE(pf->chunk_count * i / pf->nthreads,
+                pf->chunk_count * (i + 1) / pf->nthreads);
+        workers[i].shared = pf;
+        workers[i].index = i;
+    }
+
+    __par_run_workers(pf->nthreads, __par_for_worker, workers, sizeof(__par_for_worker_t));
+
+    cstl_free(workers);
+    cstl_free(pf->queues);
+    pf->queues = NULL;
+}
+
+void vec_parallel_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *user_data, int nthreads)
+{
+    __par_for_t pf;
+
+    assert(vec && vec_foreach_func && nthreads >= 0);
+
+    __par_for_init(&pf, vec, user_data, nthreads);
+    pf.foreach_func = vec_foreach_func;
+    if (pf.nthreads <= 1) {
+        __par_for_run_chunk(&pf, 0);
+        return;
+    }
+    __par_for_run(&pf);
+}
+
+void vec_parallel_reduce(const VEC *vec, vec_map_func_t map_func, vec_reduce_func_t reduce_func,
+        const void *identity, void *result, size_t result_size, void *user_data, int nthreads)
+{
+    __par_for_t pf;
+
+    assert(vec && map_func && reduce_func && identity && result && result_size > 0 && nthreads >= 0);
+
+    __par_for_init(&pf, vec, user_data, nthreads);
+    pf.map_func = map_func;
+    pf.acc_size = result_size;
+    pf.accs = (char *)cstl_malloc(pf.chunk_count * result_size);
+    for (size_t c = 0; c < pf.chunk_count; c++) {
+        memcpy(pf.accs + c * result_size, identity, result_size);
+    }
+
+    if (pf.nthreads <= 1) {
+        __par_for_run_chunk(&pf, 0);
+    } else {
+        __par_for_run(&pf);
+    }
+
+    memcpy(result, pf.accs, result_size);
+    for (size_t c = 1; c < pf.chunk_count; c++) {
+        (*reduce_func)(result, pf.accs + c * result_size, user_data);
+    }
+    cstl_free(pf.accs);
+}
+
+#undef CHUNK_END
+#undef CHUNK_NEXT
+#undef CHUNK_RANGE
+
+// 稳定排序使用的是timsort风格的自适应归并排序：
+// - 从左到右找出自然有序的区间(run)，严格降序的区间直接翻转
+// - 太短的run使用二分插入排序扩展到minrun的长度
+// - run压入栈中，维持栈上run长度的不变式，保证归并是平衡的，总的复杂度是O(n log n)
+// - 归并前先跳过已经在最终位置的前缀和后缀，再把较短的一侧复制到缓冲区中进行归并
+// - 缓冲区在整个排序过程中复用，只在需要更大空间的时候扩容
+
+#define STABLE_SORT_MIN_MERGE 64            // 小于这个数目时直接使用二分插入排序
+#define STABLE_SORT_MAX_RUNS 85             // run栈的最大深度，对于2^64个元素也足够了
+
+typedef struct {
+    char *base;         // 第一个元素的地址
+    size_t unit;        // 单个元素的尺寸
+    cmp_func_t cmp;
+    char *buf;          // 归并时使用的缓冲区
+    size_t buf_count;   // 缓冲区能够容纳的元素数目
+    size_t run_beg[STABLE_SORT_MAX_RUNS];
+    size_t run_len[STABLE_SORT_MAX_RUNS];
+    int run_count;
+} __stable_sort_ctx_t;
+
+#define ELEM(ctx, i) ((ctx)->base + (size_t)(i) * (ctx)->unit)
+
+static inline bool
+__stable_less(__stable_sort_ctx_t *ctx, const void *lhs, const void *rhs)
+{
+    return (*ctx->cmp)(lhs, rhs) < 0;
+}
+
+static char *
+__stable_sort_buf(__stable_sort_ctx_t *ctx, size_t count)
+{
+    if (count > ctx->buf_count) {
+        size_t new_count = CSTL_MAX(count, ctx->buf_count * 2);
+        __free(ctx->buf);
+        ctx->buf = (char *)cstl_malloc(new_count * ctx->unit);
+        ctx->buf_count = new_count;
+    }
+    return ctx->buf;
+}
+
+// [begin, sorted)已经有序，使用二分插入排序把[sorted, end)插入进来，相等元素插在后面保证稳定
+static void
+__binary_insertion_sort(__stable_sort_ctx_t *ctx, size_t begin, size_t sorted, size_t end)
+{
+    char *tmp = __stable_sort_buf(ctx, 1);
+
+    for (size_t i = sorted; i < end; i++) {
+        size_t lo = begin, hi = i;
+
+        memcpy(tmp, ELEM(ctx, i), ctx->unit);
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (__stable_less(ctx, tmp, ELEM(ctx, mid))) hi = mid;
+            else lo = mid + 1;
+        }
+        memmove(ELEM(ctx, lo + 1), ELEM(ctx, lo), (i - lo) * ctx->unit);
+        memcpy(ELEM(ctx, lo), tmp, ctx->unit);
+    }
+}
+
+// 返回从begin开始的run的长度，如果是严格降序的则翻转成升序
+static size_t
+__count_run(__stable_sort_ctx_t *ctx, size_t begin, size_t end)
+{
+    size_t i = begin + 1;
+
+    if (i == end) return 1;
+
+    if (__stable_less(ctx, ELEM(ctx, i), ELEM(ctx, begin))) {
+        while (++i < end && __stable_less(ctx, ELEM(ctx, i), ELEM(ctx, i - 1)));
+        // 严格降序的区间，翻转之后不会改变相等元素的相对顺序
+        char *tmp = __stable_sort_buf(ctx, 1);
+        for (size_t l = begin, r = i - 1; l < r; l++, r--) {
+            memcpy(tmp, ELEM(ctx, l), ctx->unit);
+            memcpy(ELEM(ctx, l), ELEM(ctx, r), ctx->unit);
+            memcpy(ELEM(ctx, r), tmp, ctx->unit);
+        }
+    } else {
+        while (++i < end && !__stable_less(ctx, ELEM(ctx, i), ELEM(ctx, i - 1)));
+    }
+    return i - begin;
+}
+
+static size_t
+__min_run_length(size_t n)
+{
+    size_t r = 0;
+
+    while (n >= STABLE_SORT_MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// 归并相邻的两个有序区间[lo, mid)和[mid, hi)
+static void
+__merge_runs(__stable_sort_ctx_t *ctx, size_t lo, size_t mid, size_t hi)
+{
+    size_t unit = ctx->unit;
+    char *buf;
+
+    // 左侧小于等于右侧第一个元素的前缀已经在最终位置上
+    {
+        size_t l = lo, r = mid;
+        while (l < r) {
+            size_t m = l + (r - l) / 2;
+            if (__stable_less(ctx, ELEM(ctx, mid), ELEM(ctx, m))) r = m;
+            else l = m + 1;
+        }
+        lo = l;
+    }
+    if (lo == mid) return;
+
+    // 右侧大于等于左侧最后一个元素的后缀已经在最终位置上
+    {
+        size_t l = mid, r = hi;
+        while (l < r) {
+            size_t m = l + (r - l) / 2;
+            if (__stable_less(ctx, ELEM(ctx, m), ELEM(ctx, mid - 1))) l = m + 1;
+            else r = m;
+        }
+        hi = l;
+    }
+
+    if (mid - lo <= hi - mid) {
+        // 左侧较短，复制到缓冲区，从前往后归并
+        size_t n1 = mid - lo, i = 0, j = mid, k = lo;
+
+        buf = __stable_sort_buf(ctx, n1);
+        memcpy(buf, ELEM(ctx, lo), n1 * unit);
+        while (i < n1 && j < hi) {
+            if (__stable_less(ctx, ELEM(ctx, j), buf + i * unit)) {
+                memcpy(ELEM(ctx, k++), ELEM(ctx, j++), unit);
+            } else {
+                memcpy(ELEM(ctx, k++), buf + (i++) * unit, unit);
+            }
+        }
+        memcpy(ELEM(ctx, k), buf + i * unit, (n1 - i) * unit);
+    } else {
+        // 右侧较短，复制到缓冲区，从后往前归并
+        size_t n2 = hi - mid, i = mid, j = n2, k = hi;
+
+        buf = __stable_sort_buf(ctx, n2);
+        memcpy(buf, ELEM(ctx, mid), n2 * unit);
+        while (i > lo && j > 0) {
+            if (__stable_less(ctx, buf + (j - 1) * unit, ELEM(ctx, i - 1))) {
+                memcpy(ELEM(ctx, --k), ELEM(ctx, --i), unit);
+            } else {
+                memcpy(ELEM(ctx, --k), buf + (--j) * unit, unit);
+            }
+        }
+        memcpy(ELEM(ctx, lo), buf, j * unit);
+    }
+}
+
+// 归并栈上第i个和第i+1个run
+static void
+__merge_at(__stable_sort_ctx_t *ctx, int i)
+{
+    size_t beg = ctx->run_beg[i];
+    size_t mid = beg + ctx->run_len[i];
+    size_t end = mid + ctx->run_len[i + 1];
+
+    __merge_runs(ctx, beg, mid, end);
+    ctx->run_len[i] += ctx->run_len[i + 1];
+    if (i == ctx->run_count - 3) {
+        ctx->run_beg[i + 1] = ctx->run_beg[i + 2];
+        ctx->run_len[i + 1] = ctx->run_len[i + 2];
+    }
+    ctx->run_count--;
+}
+
+// 维持不变式：len[i-2] > len[i-1] + len[i]，len[i-1] > len[i]
+static void
+__merge_collapse(__stable_sort_ctx_t *ctx)
+{
+    size_t *len = ctx->run_len;
+
+    while (ctx->run_count > 1) {
+        int n = ctx->run_count - 2;
+        if ((n > 0 && len[n - 1] <= len[n] + len[n + 1])
+                || (n > 1 && len[n - 2] <= len[n - 1] + len[n])) {
+            if (len[n - 1] < len[n + 1]) n--;
+            __merge_at(ctx, n);
+        } else if (len[n] <= len[n + 1]) {
+            __merge_at(ctx, n);
+        } else {
+            break;
+        }
+    }
+}
+
+static void
+__merge_force_collapse(__stable_sort_ctx_t *ctx)
+{
+    while (ctx->run_count > 1) {
+        int n = ctx->run_count - 2;
+        if (n > 0 && ctx->run_len[n - 1] < ctx->run_len[n + 1]) n--;
+        __merge_at(ctx, n);
+    }
+}
+
+#undef ELEM
+
+void vec_stable_sort(VEC *vec, cmp_func_t compare)
+{
+    size_t n, begin = 0, min_run;
+    __stable_sort_ctx_t ctx;
+
+    assert(vec && compare);
+
+    n = vec_size(vec);
+    if (n < 2) return;
+
+    ctx.base = (char *)vec->beg;
+    ctx.unit = vec->unit_size;
+    ctx.cmp = compare;
+    ctx.buf = NULL;
+    ctx.buf_count = 0;
+    ctx.run_count = 0;
+
+    if (n < STABLE_SORT_MIN_MERGE) {
+        __binary_insertion_sort(&ctx, 0, __count_run(&ctx, 0, n), n);
+        __free(ctx.buf);
+        return;
+    }
+
+    min_run = __min_run_length(n);
+    while (begin < n) {
+        size_t run = __count_run(&ctx, begin, n);
+
+        if (run < min_run) {
+            size_t forced = CSTL_MIN(min_run, n - begin);
+            __binary_insertion_sort(&ctx, begin, begin + run, begin + forced);
+            run = forced;
+        }
+
+        ctx.run_beg[ctx.run_count] = begin;
+        ctx.run_len[ctx.run_count] = run;
+        ctx.run_count++;
+        __merge_collapse(&ctx);
+
+        begin += run;
+    }
+    __merge_force_collapse(&ctx);
+
+    __free(ctx.buf);
+}
+
+// 基数排序：先将元素转换为可以按照无符号整数比较的key，排序完成之后再转换回来
+// - 有符号整数：翻转符号位
+// - 浮点数：正数翻转符号位，负数翻转所有的位
+
+#define RADIX_SORT_INSERTION_THRESHOLD 64   // 小于这个数目时候使用插入排序
+
+#define DEFINE_RADIX_SORT(bits) \
+static void \
+__radix_sort_u##bits(uint##bits##_t *data, size_t n, vec_radix_key_t kind) \
+{ \
+    const uint##bits##_t sign = (uint##bits##_t)1 << (bits - 1); \
+    size_t count[bits / 8][256]; \
+    uint##bits##_t *src = data, *dst, *tmp; \
+ \
+    for (size_t i = 0; i < n; i++) { \
+        uint##bits##_t x = data[i]; \
+        if (kind == VEC_RADIX_SIGNED) x ^= sign; \
+        else if (kind == VEC_RADIX_FLOAT) x ^= (uint##bits##_t)(0 - (x >> (bits - 1))) | sign; \
+        data[i] = x; \
+    } \
+ \
+    if (n < RADIX_SORT_INSERTION_THRESHOLD) { \
+        for (size_t i = 1; i < n; i++) { \
+            uint##bits##_t x = data[i]; \
+            size_t j = i; \
+            for (; j > 0 && data[j - 1] > x; j--) data[j] = data[j - 1]; \
+            data[j] = x; \
+        } \
+    } else { \
+        dst = (uint##bits##_t *)cstl_malloc(n * sizeof(uint##bits##_t)); \
+ \
+        /* 一次遍历统计出所有字节的直方图 */ \
+        memset(count, 0, sizeof(count)); \
+        for (size_t i = 0; i < n; i++) { \
+            uint##bits##_t x = data[i]; \
+            for (int b = 0; b < bits / 8; b++) { \
+                count[b][(x >> (b * 8)) & 0xff]++; \
+            } \
+        } \
+ \
+        for (int b = 0; b < bits / 8; b++) { \
+            size_t *c = count[b], sum = 0; \
+            int shift = b * 8; \
+ \
+            /* 所有元素这个字节都相同，不需要分配 */ \
+            if (c[(src[0] >> shift) & 0xff] == n) continue; \
+ \
+            for (int d = 0; d < 256; d++) { \
+                size_t cnt = c[d]; \
+                c[d] = sum; \
+                sum += cnt; \
+            } \
+            for (size_t i = 0; i < n; i++) { \
+                dst[c[(src[i] >> shift) & 0xff]++] = src[i]; \
+            } \
+            tmp = src; src = dst; dst = tmp; \
+        } \
+ \
+        if (src != data) { \
+            memcpy(data, src, n * sizeof(uint##bits##_t)); \
+            dst = src; \
+        } \
+        cstl_free(dst); \
+    } \
+ \
+    for (size_t i = 0; i < n; i++) { \
+        uint##bits##_t x = data[i]; \
+        if (kind == VEC_RADIX_SIGNED) x ^= sign; \
+        else if (kind == VEC_RADIX_FLOAT) x ^= (uint##bits##_t)((x >> (bits - 1)) - 1) | sign; \
+        data[i] = x; \
+    } \
+}
+
+DEFINE_RADIX_SORT(8)
+DEFINE_RADIX_SORT(16)
+DEFINE_RADIX_SORT(32)
+DEFINE_RADIX_SORT(64)
+
+#undef DEFINE_RADIX_SORT
+
+void vec_radix_sort(VEC *vec, vec_radix_key_t kind)
+{
+    size_t n;
+
+    assert(vec);
+    assert(kind != VEC_RADIX_FLOAT || vec->unit_size == 4 || vec->unit_size == 8);
+
+    n = vec_size(vec);
+    if (n < 2) return;
+
+    switch (vec->unit_size) {
+        case 1: __radix_sort_u8((uint8_t *)vec->beg, n, kind); break;
+        case 2: __radix_sort_u16((uint16_t *)vec->beg, n, kind); break;
+        case 4: __radix_sort_u32((uint32_t *)vec->beg, n, kind); break;
+        case 8: __radix_sort_u64((uint64_t *)vec->beg, n, kind); break;
+        default: assert(0 && "vec_radix_sort only supports element size 1, 2, 4, 8"); break;
+    }
+}
+
+// 视图的函数构造一个指向视图内存的临时vec，复用vec的实现。
+// 这些函数都不会改变vec的容量，所以不会释放或者重新分配视图的内存
+static inline VEC *
+__vec_from_view(VEC *tmp, vec_view_t view)
+{
+    assert(view.unit_size > 0 && view.len <= INT_MAX);
+    assert(view.beg || view.len == 0);
+
+    __vec_init(tmp, view.unit_size, NULL);
+    tmp->beg = view.beg;
+    tmp->len = (int)view.len;
+    tmp->capacity = (int)view.len;
+    return tmp;
+}
+
+vec_view_t vec_view(VEC *vec)
+{
+    assert(vec);
+    return vec_view_of(vec->beg, vec_size(vec), vec->unit_size);
+}
+
+vec_view_t vec_slice(VEC *vec, size_t from, size_t to)
+{
+    return vec_view_slice(vec_view(vec), from, to);
+}
+
+vec_view_t vec_view_of(void *data, size_t len, int unit_size)
+{
+    vec_view_t view;
+
+    assert(unit_size > 0 && (data || len == 0));
+
+    view.beg = data;
+    view.len = len;
+    view.unit_size = unit_size;
+    return view;
+}
+
+vec_view_t vec_view_slice(vec_view_t view, size_t from, size_t to)
+{
+    assert(from <= to && to <= view.len);
+
+    if (view.beg) {
+        view.beg = (char*)view.beg + from * view.unit_size;
+    }
+    view.len = to - from;
+    return view;
+}
+
+void *vec_view_get(vec_view_t view, size_t index)
+{
+    if (index >= view.len) return NULL;
+    return (char*)view.beg + index * view.unit_size;
+}
+
+void vec_view_sort(vec_view_t view, cmp_func_t compare)
+{
+    VEC tmp;
+    vec_sort(__vec_from_view(&tmp, view), compare);
+}
+
+void vec_view_stable_sort(vec_view_t view, cmp_func_t compare)
+{
+    VEC tmp;
+    vec_stable_sort(__vec_from_view(&tmp, view), compare);
+}
+
+void vec_view_nth_element(vec_view_t view, size_t k, cmp_func_t compare)
+{
+    VEC tmp;
+    vec_nth_element(__vec_from_view(&tmp, view), k, compare);
+}
+
+void *vec_view_find(vec_view_t view, const void *val, cmp_func_t compare)
+{
+    VEC tmp;
+    return vec_find(__vec_from_view(&tmp, view), val, compare);
+}
+
+void *vec_view_bin_find(vec_view_t view, const void *val, cmp_func_t compare)
+{
+    VEC tmp;
+    return vec_bin_find(__vec_from_view(&tmp, view), val, compare);
+}
+
+size_t vec_view_lower_bound(vec_view_t view, const void *val, cmp_func_t compare)
+{
+    VEC tmp;
+    return vec_lower_bound(__vec_from_view(&tmp, view), val, compare);
+}
+
+size_t vec_view_upper_bound(vec_view_t view, const void *val, cmp_func_t compare)
+{
+    VEC tmp;
+    return vec_upper_bound(__vec_from_view(&tmp, view), val, compare);
+}
+
+void vec_argsort(const VEC *vec, cmp_func_t compare, size_t *indices)
+{
+    size_t n, offset, entry_size;
+    char *entries;
+
+    assert(vec && compare && indices);
+
+    n = vec_size(vec);
+    if (n == 0) return;
+
+    // 每一项是元素的副本后面跟着它的索引，比较函数只会读取开头的元素，所以可以直接用来排序这些项
+    offset = (vec->unit_size + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+    entry_size = offset + sizeof(size_t);
+    entries = (char*)cstl_malloc(n * entry_size);
+    for (size_t i = 0; i < n; i++) {
+        memcpy(entries + i * entry_size, (char*)vec->beg + i * vec->unit_size, vec->unit_size);
+        memcpy(entries + i * entry_size + offset, &i, sizeof(size_t));
+    }
+
+    vec_view_stable_sort(vec_view_of(entries, n, entry_size), compare);
+
+    for (size_t i = 0; i < n; i++) {
+        memcpy(&indices[i], entries + i * entry_size + offset, sizeof(size_t));
+    }
+    cstl_free(entries);
+}
+
+void vec_permute(VEC *vec, const size_t *indices)
+{
+    size_t n, unit;
+    char *tmp;
+
+    assert(vec && indices);
+
+    n = vec_size(vec);
+    if (n < 2) return;
+
+    unit = vec->unit_size;
+    tmp = (char*)cstl_malloc(n * unit);
+    for (size_t i = 0; i < n; i++) {
+        assert(indices[i] < n);
+        memcpy(tmp + i * unit, (char*)vec->beg + indices[i] * unit, unit);
+    }
+    memcpy(vec->beg, tmp, n * unit);
+    cstl_free(tmp);
+}
+
+void vec_sort_columns(VEC **columns, int count, const VEC *key, cmp_func_t compare)
+{
+    size_t n, *indices;
+
+    assert(columns && count >= 0 && key && compare);
+
+    n = vec_size(key);
+    if (n < 2) return;
+
+    indices = (size_t*)cstl_malloc(n * sizeof(size_t));
+    vec_argsort(key, compare, indices);
+    for (int i = 0; i < count; i++) {
+        assert(vec_size(columns[i]) == n);
+        vec_permute(columns[i], indices);
+    }
+    cstl_free(indices);
+}
+
+void vec_foreach(VEC *vec, vec_foreach_func_t vec_foreach_func, void *user_data)
+{
+    assert(vec && "vec can't be null!");
+    assert(vec_foreach_func && "foreach callback can't be null!");
+
+    for (size_t i = 0; i < vec_size(vec); i++) {
+        (*vec_foreach_func)(vec_get(vec, i), user_data);
+    }
+}
+
+void vec_free(VEC *vec)
+{
+    assert(vec);
+
+    vec_deinit(vec);
     __free(vec);
 }
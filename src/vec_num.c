@@ -0,0 +1,470 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 16:05:12
+*/
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "vec_num.h"
+
+// 只在x86下的gcc/clang中提供手写的AVX2实现，运行时检测cpu是否支持
+#if !defined(CSTL_VEC_NUM_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define VEC_NUM_X86 1
+#   include <immintrin.h>
+#else
+#   define VEC_NUM_X86 0
+#endif
+
+#define SCALAR_BLOCK 16     // 标量查找时每次检查的元素数目，块内没有分支，编译器可以自动向量化
+
+// 标量实现，所有平台都可以使用
+#define DEFINE_SCALAR_KERNELS(name, type) \
+static size_t \
+__scalar_index_of_##name(const type *data, size_t n, type value) \
+{ \
+    size_t i = 0; \
+    for (; i + SCALAR_BLOCK <= n; i += SCALAR_BLOCK) { \
+        int hit = 0; \
+        for (int k = 0; k < SCALAR_BLOCK; k++) { \
+            hit |= (data[i + k] == value); \
+        } \
+        if (hit) break; \
+    } \
+    for (; i < n; i++) { \
+        if (data[i] == value) return i; \
+    } \
+    return n; \
+} \
+ \
+static size_t \
+__scalar_count_##name(const type *data, size_t n, type value) \
+{ \
+    size_t count = 0; \
+    for (size_t i = 0; i < n; i++) { \
+        count += (data[i] == value); \
+    } \
+    return count; \
+} \
+ \
+static type \
+__scalar_min_##name(const type *data, size_t n) \
+{ \
+    type result = data[0]; \
+    for (size_t i = 1; i < n; i++) { \
+        if (data[i] < result) result = data[i]; \
+    } \
+    return result; \
+} \
+ \
+static type \
+__scalar_max_##name(const type *data, size_t n) \
+{ \
+    type result = data[0]; \
+    for (size_t i = 1; i < n; i++) { \
+        if (data[i] > result) result = data[i]; \
+    } \
+    return result; \
+}
+
+DEFINE_SCALAR_KERNELS(i32, int32_t)
+DEFINE_SCALAR_KERNELS(i64, int64_t)
+DEFINE_SCALAR_KERNELS(f32, float)
+DEFINE_SCALAR_KERNELS(f64, double)
+
+#undef DEFINE_SCALAR_KERNELS
+
+#if VEC_NUM_X86
+
+#define AVX2 __attribute__((target("avx2,popcnt")))
+
+// 每种类型的加载、存储、比较和最值操作，下面的宏通过它们生成具体的函数
+
+static AVX2 inline __m256i __avx2_load_i32(const int32_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+static AVX2 inline __m256i __avx2_load_i64(const int64_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+static AVX2 inline __m256 __avx2_load_f32(const float *p) { return _mm256_loadu_ps(p); }
+static AVX2 inline __m256d __avx2_load_f64(const double *p) { return _mm256_loadu_pd(p); }
+
+static AVX2 inline void __avx2_store_i32(int32_t *p, __m256i v) { _mm256_storeu_si256((__m256i *)p, v); }
+static AVX2 inline void __avx2_store_i64(int64_t *p, __m256i v) { _mm256_storeu_si256((__m256i *)p, v); }
+static AVX2 inline void __avx2_store_f32(float *p, __m256 v) { _mm256_storeu_ps(p, v); }
+static AVX2 inline void __avx2_store_f64(double *p, __m256d v) { _mm256_storeu_pd(p, v); }
+
+static AVX2 inline __m256i __avx2_set1_i32(int32_t x) { return _mm256_set1_epi32(x); }
+static AVX2 inline __m256i __avx2_set1_i64(int64_t x) { return _mm256_set1_epi64x(x); }
+static AVX2 inline __m256 __avx2_set1_f32(float x) { return _mm256_set1_ps(x); }
+static AVX2 inline __m256d __avx2_set1_f64(double x) { return _mm256_set1_pd(x); }
+
+// 返回相等的元素的位掩码，第k位对应第k个元素
+static AVX2 inline int
+__avx2_eq_mask_i32(const int32_t *p, __m256i v)
+{
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(__avx2_load_i32(p), v)));
+}
+
+static AVX2 inline int
+__avx2_eq_mask_i64(const int64_t *p, __m256i v)
+{
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(__avx2_load_i64(p), v)));
+}
+
+static AVX2 inline int
+__avx2_eq_mask_f32(const float *p, __m256 v)
+{
+    return _mm256_movemask_ps(_mm256_cmp_ps(__avx2_load_f32(p), v, _CMP_EQ_OQ));
+}
+
+static AVX2 inline int
+__avx2_eq_mask_f64(const double *p, __m256d v)
+{
+    return _mm256_movemask_pd(_mm256_cmp_pd(__avx2_load_f64(p), v, _CMP_EQ_OQ));
+}
+
+static AVX2 inline __m256i __avx2_vmin_i32(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+static AVX2 inline __m256i __avx2_vmax_i32(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+static AVX2 inline __m256 __avx2_vmin_f32(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+static AVX2 inline __m256 __avx2_vmax_f32(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+static AVX2 inline __m256d __avx2_vmin_f64(__m256d a, __m256d b) { return _mm256_min_pd(a, b); }
+static AVX2 inline __m256d __avx2_vmax_f64(__m256d a, __m256d b) { return _mm256_max_pd(a, b); }
+
+// AVX2没有64位整数的最值指令，使用比较和混合来实现
+static AVX2 inline __m256i
+__avx2_vmin_i64(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+static AVX2 inline __m256i
+__avx2_vmax_i64(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+}
+
+#define DEFINE_AVX2_KERNELS(name, type, vtype, lanes) \
+static AVX2 size_t \
+__avx2_index_of_##name(const type *data, size_t n, type value) \
+{ \
+    vtype v = __avx2_set1_##name(value); \
+    size_t i = 0; \
+    for (; i + 2 * lanes <= n; i += 2 * lanes) { \
+        int m0 = __avx2_eq_mask_##name(data + i, v); \
+        int m1 = __avx2_eq_mask_##name(data + i + lanes, v); \
+        if (m0 | m1) { \
+            return i + (m0 ? __builtin_ctz(m0) : lanes + __builtin_ctz(m1)); \
+        } \
+    } \
+    for (; i < n; i++) { \
+        if (data[i] == value) return i; \
+    } \
+    return n; \
+} \
+ \
+static AVX2 size_t \
+__avx2_count_##name(const type *data, size_t n, type value) \
+{ \
+    vtype v = __avx2_set1_##name(value); \
+    size_t i = 0, count = 0; \
+    for (; i + lanes <= n; i += lanes) { \
+        count += __builtin_popcount(__avx2_eq_mask_##name(data + i, v)); \
+    } \
+    for (; i < n; i++) { \
+        count += (data[i] == value); \
+    } \
+    return count; \
+} \
+ \
+static AVX2 type \
+__avx2_min_##name(const type *data, size_t n) \
+{ \
+    vtype acc = __avx2_set1_##name(data[0]); \
+    type lane[lanes], result; \
+    size_t i = 0; \
+    for (; i + lanes <= n; i += lanes) { \
+        acc = __avx2_vmin_##name(__avx2_load_##name(data + i), acc); \
+    } \
+    __avx2_store_##name(lane, acc); \
+    result = lane[0]; \
+    for (int k = 1; k < lanes; k++) { \
+        if (lane[k] < result) result = lane[k]; \
+    } \
+    for (; i < n; i++) { \
+        if (data[i] < result) result = data[i]; \
+    } \
+    return result; \
+} \
+ \
+static AVX2 type \
+__avx2_max_##name(const type *data, size_t n) \
+{ \
+    vtype acc = __avx2_set1_##name(data[0]); \
+    type lane[lanes], result; \
+    size_t i = 0; \
+    for (; i + lanes <= n; i += lanes) { \
+        acc = __avx2_vmax_##name(__avx2_load_##name(data + i), acc); \
+    } \
+    __avx2_store_##name(lane, acc); \
+    result = lane[0]; \
+    for (int k = 1; k < lanes; k++) { \
+        if (lane[k] > result) result = lane[k]; \
+    } \
+    for (; i < n; i++) { \
+        if (data[i] > result) result = data[i]; \
+    } \
+    return result; \
+}
+
+DEFINE_AVX2_KERNELS(i32, int32_t, __m256i, 8)
+DEFINE_AVX2_KERNELS(i64, int64_t, __m256i, 4)
+DEFINE_AVX2_KERNELS(f32, float, __m256, 8)
+DEFINE_AVX2_KERNELS(f64, double, __m256d, 4)
+
+#undef DEFINE_AVX2_KERNELS
+
+// 是否使用AVX2实现，第一次调用时检测cpu特性，检测的结果是确定的，所以多个线程同时检测也没有问题
+static bool
+__use_avx2(void)
+{
+    static int supported = -1;  // -1表示还没有检测
+    int value = __atomic_load_n(&supported, __ATOMIC_RELAXED);
+
+    if (value < 0) {
+        __builtin_cpu_init();
+        value = __builtin_cpu_supports("avx2") ? 1 : 0;
+        __atomic_store_n(&supported, value, __ATOMIC_RELAXED);
+    }
+    return value != 0;
+}
+
+#define DISPATCH(op, name) (__use_avx2() ? __avx2_##op##_##name : __scalar_##op##_##name)
+
+#else
+
+#define DISPATCH(op, name) __scalar_##op##_##name
+
+#endif //VEC_NUM_X86
+
+#define ACC_LANES 8     // 归约时候使用的独立累加器的数目，打断循环依赖，编译器可以把它们放到一个向量寄存器中
+
+// 归约和变换的实现，循环体中没有分支和函数调用，编译器可以自动向量化。
+// x86下同一份代码会再以AVX2为目标编译一次，运行时和查找函数一样进行选择
+#define DEFINE_ARITH_KERNELS(prefix, attr, name, type, acc_type) \
+static attr acc_type \
+prefix##_sum_##name(const type *data, size_t n) \
+{ \
+    acc_type acc[ACC_LANES] = {0}; \
+    acc_type result = 0; \
+    size_t i = 0; \
+    for (; i + ACC_LANES <= n; i += ACC_LANES) { \
+        for (int k = 0; k < ACC_LANES; k++) { \
+            acc[k] += data[i + k]; \
+        } \
+    } \
+    for (int k = 0; k < ACC_LANES; k++) { \
+        result += acc[k]; \
+    } \
+    for (; i < n; i++) { \
+        result += data[i]; \
+    } \
+    return result; \
+} \
+ \
+static attr acc_type \
+prefix##_dot_##name(const type *a, const type *b, size_t n) \
+{ \
+    acc_type acc[ACC_LANES] = {0}; \
+    acc_type result = 0; \
+    size_t i = 0; \
+    for (; i + ACC_LANES <= n; i += ACC_LANES) { \
+        for (int k = 0; k < ACC_LANES; k++) { \
+            acc[k] += (acc_type)a[i + k] * b[i + k]; \
+        } \
+    } \
+    for (int k = 0; k < ACC_LANES; k++) { \
+        result += acc[k]; \
+    } \
+    for (; i < n; i++) { \
+        result += (acc_type)a[i] * b[i]; \
+    } \
+    return result; \
+} \
+ \
+static attr void \
+prefix##_scale_##name(type *data, size_t n, type factor) \
+{ \
+    for (size_t i = 0; i < n; i++) { \
+        data[i] *= factor; \
+    } \
+} \
+ \
+static attr void \
+prefix##_add_scalar_##name(type *data, size_t n, type delta) \
+{ \
+    for (size_t i = 0; i < n; i++) { \
+        data[i] += delta; \
+    } \
+} \
+ \
+static attr void \
+prefix##_add_##name(type *restrict dst, const type *restrict src, size_t n) \
+{ \
+    for (size_t i = 0; i < n; i++) { \
+        dst[i] += src[i]; \
+    } \
+} \
+ \
+static attr void \
+prefix##_clamp_##name(type *data, size_t n, type lo, type hi) \
+{ \
+    for (size_t i = 0; i < n; i++) { \
+        type x = data[i]; \
+        x = (x < lo) ? lo : x; \
+        data[i] = (x > hi) ? hi : x; \
+    } \
+}
+
+DEFINE_ARITH_KERNELS(__scalar, , i32, int32_t, int64_t)
+DEFINE_ARITH_KERNELS(__scalar, , i64, int64_t, int64_t)
+DEFINE_ARITH_KERNELS(__scalar, , f32, float, double)
+DEFINE_ARITH_KERNELS(__scalar, , f64, double, double)
+
+#if VEC_NUM_X86
+DEFINE_ARITH_KERNELS(__avx2, AVX2, i32, int32_t, int64_t)
+DEFINE_ARITH_KERNELS(__avx2, AVX2, i64, int64_t, int64_t)
+DEFINE_ARITH_KERNELS(__avx2, AVX2, f32, float, double)
+DEFINE_ARITH_KERNELS(__avx2, AVX2, f64, double, double)
+#endif
+
+#undef DEFINE_ARITH_KERNELS
+
+const char *vec_num_isa(void)
+{
+#if VEC_NUM_X86
+    if (__use_avx2()) return "avx2";
+#endif
+    return "scalar";
+}
+
+// name是内部实现使用的定长类型
+#define DEFINE_NUM_VEC_SEARCH(type, name) \
+size_t type##_vec_index_of(const VEC *vec, type value) \
+{ \
+    assert(vec && vec->unit_size == sizeof(type)); \
+    return DISPATCH(index_of, name)(vec->beg, vec_size(vec), value); \
+} \
+ \
+size_t type##_vec_count(const VEC *vec, type value) \
+{ \
+    assert(vec && vec->unit_size == sizeof(type)); \
+    return DISPATCH(count, name)(vec->beg, vec_size(vec), value); \
+} \
+ \
+bool type##_vec_contains(const VEC *vec, type value) \
+{ \
+    return type##_vec_index_of(vec, value) < vec_size(vec); \
+} \
+ \
+bool type##_vec_min(const VEC *vec, type *result) \
+{ \
+    assert(vec && result && vec->unit_size == sizeof(type)); \
+    if (vec_empty(vec)) return false; \
+    *result = DISPATCH(min, name)(vec->beg, vec_size(vec)); \
+    return true; \
+} \
+ \
+bool type##_vec_max(const VEC *vec, type *result) \
+{ \
+    assert(vec && result && vec->unit_size == sizeof(type)); \
+    if (vec_empty(vec)) return false; \
+    *result = DISPATCH(max, name)(vec->beg, vec_size(vec)); \
+    return true; \
+}
+
+DEFINE_NUM_VEC_SEARCH(int, i32)
+#if LONG_MAX == INT32_MAX
+DEFINE_NUM_VEC_SEARCH(long, i32)
+#else
+DEFINE_NUM_VEC_SEARCH(long, i64)
+#endif
+DEFINE_NUM_VEC_SEARCH(float, f32)
+DEFINE_NUM_VEC_SEARCH(double, f64)
+
+#undef DEFINE_NUM_VEC_SEARCH
+
+#define DEFINE_NUM_VEC_ARITH(type, name, sum_type) \
+sum_type type##_vec_sum(const VEC *vec) \
+{ \
+    assert(vec && vec->unit_size == sizeof(type)); \
+    return (sum_type)DISPATCH(sum, name)(vec->beg, vec_size(vec)); \
+} \
+ \
+sum_type type##_vec_dot(const VEC *a, const VEC *b) \
+{ \
+    assert(a && a->unit_size == sizeof(type)); \
+    assert(b && b->unit_size == sizeof(type)); \
+    assert(vec_size(a) == vec_size(b)); \
+    return (sum_type)DISPATCH(dot, name)(a->beg, b->beg, vec_size(a)); \
+} \
+ \
+void type##_vec_prefix_sum(VEC *vec) \
+{ \
+    type *data; \
+    size_t n; \
+    assert(vec && vec->unit_size == sizeof(type)); \
+    /* 每个元素都依赖前一个元素，不能向量化，但是仍然省去了每个元素一次的回调 */ \
+    data = (type *)vec->beg; \
+    n = vec_size(vec); \
+    for (size_t i = 1; i < n; i++) { \
+        data[i] += data[i - 1]; \
+    } \
+} \
+ \
+void type##_vec_scale(VEC *vec, type factor) \
+{ \
+    assert(vec && vec->unit_size == sizeof(type)); \
+    DISPATCH(scale, name)(vec->beg, vec_size(vec), factor); \
+} \
+ \
+void type##_vec_add_scalar(VEC *vec, type delta) \
+{ \
+    assert(vec && vec->unit_size == sizeof(type)); \
+    DISPATCH(add_scalar, name)(vec->beg, vec_size(vec), delta); \
+} \
+ \
+void type##_vec_add(VEC *dst, const VEC *src) \
+{ \
+    assert(dst && dst->unit_size == sizeof(type)); \
+    assert(src && src->unit_size == sizeof(type)); \
+    assert(vec_size(dst) == vec_size(src)); \
+    if (dst == src) { \
+        DISPATCH(scale, name)(dst->beg, vec_size(dst), (type)2); \
+        return; \
+    } \
+    DISPATCH(add, name)(dst->beg, src->beg, vec_size(dst)); \
+} \
+ \
+void type##_vec_clamp(VEC *vec, type lo, type hi) \
+{ \
+    assert(vec && vec->unit_size == sizeof(type)); \
+    assert(!(hi < lo)); \
+    DISPATCH(clamp, name)(vec->beg, vec_size(vec), lo, hi); \
+}
+
+DEFINE_NUM_VEC_ARITH(int, i32, long long)
+#if LONG_MAX == INT32_MAX
+DEFINE_NUM_VEC_ARITH(long, i32, long long)
+#else
+DEFINE_NUM_VEC_ARITH(long, i64, long long)
+#endif
+DEFINE_NUM_VEC_ARITH(float, f32, double)
+DEFINE_NUM_VEC_ARITH(double, f64, double)
+
+#undef DEFINE_NUM_VEC_ARITH
+#undef DISPATCH
+#undef SCALAR_BLOCK
+#undef ACC_LANES
+#if VEC_NUM_X86
+#undef AVX2
+#endif
+#undef VEC_NUM_X86
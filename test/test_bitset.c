@@ -0,0 +1,139 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 19:16:08
+*/
+#include <check_util.h>
+
+#include "bitset.h"
+#include "leak.h"
+#include "test_common.h"
+
+START_TEST(test_bits) {
+    bitset_t *bitset = bitset_new(130);
+
+    ck_assert_int_eq(130, bitset_size(bitset));
+    ck_assert_int_eq(0, bitset_count(bitset));
+    ck_assert(!bitset_any(bitset));
+    ck_assert_int_eq(130, bitset_find_first(bitset));
+
+    bitset_set(bitset, 0);
+    bitset_set(bitset, 63);
+    bitset_set(bitset, 64);
+    bitset_set(bitset, 129);
+    bitset_flip(bitset, 100);
+    bitset_assign(bitset, 5, true);
+    bitset_assign(bitset, 0, false);
+    ck_assert(!bitset_test(bitset, 0));
+    ck_assert(bitset_test(bitset, 5));
+    ck_assert(bitset_test(bitset, 63));
+    ck_assert(bitset_test(bitset, 64));
+    ck_assert(bitset_test(bitset, 100));
+    ck_assert(bitset_test(bitset, 129));
+    ck_assert_int_eq(5, bitset_count(bitset));
+
+    // 按顺序遍历所有置位，跨过字的边界
+    size_t expects[] = {5, 63, 64, 100, 129};
+    size_t count = 0;
+    for (size_t i = bitset_find_first(bitset); i < bitset_size(bitset); i = bitset_find_next(bitset, i + 1)) {
+        ck_assert_int_eq(expects[count], i);
+        ++ count;
+    }
+    ck_assert_int_eq(ARRAY_SIZE(expects, size_t), count);
+    ck_assert_int_eq(100, bitset_find_next(bitset, 65));
+    ck_assert_int_eq(130, bitset_find_next(bitset, 130));
+
+    bitset_reset(bitset, 129);
+    ck_assert_int_eq(130, bitset_find_next(bitset, 101));
+
+    bitset_free(bitset);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_ranges) {
+    bitset_t *bitset = bitset_new(200);
+
+    // 在同一个字中
+    bitset_set_range(bitset, 3, 10);
+    ck_assert_int_eq(7, bitset_count(bitset));
+    ck_assert(!bitset_test(bitset, 2) && bitset_test(bitset, 3) && bitset_test(bitset, 9) && !bitset_test(bitset, 10));
+
+    // 跨过多个字
+    bitset_set_range(bitset, 60, 190);
+    ck_assert_int_eq(137, bitset_count(bitset));
+    bitset_reset_range(bitset, 64, 128);
+    ck_assert_int_eq(73, bitset_count(bitset));
+    ck_assert(bitset_test(bitset, 63) && !bitset_test(bitset, 64) && !bitset_test(bitset, 127) && bitset_test(bitset, 128));
+    bitset_set_range(bitset, 0, 0);
+    ck_assert_int_eq(73, bitset_count(bitset));
+
+    // 尾部多余的位总是0
+    bitset_set_all(bitset);
+    ck_assert_int_eq(200, bitset_count(bitset));
+    bitset_flip_all(bitset);
+    ck_assert_int_eq(0, bitset_count(bitset));
+    bitset_flip_all(bitset);
+    ck_assert_int_eq(200, bitset_count(bitset));
+
+    bitset_resize(bitset, 70);
+    ck_assert_int_eq(70, bitset_count(bitset));
+    bitset_resize(bitset, 300);
+    ck_assert_int_eq(70, bitset_count(bitset));
+    ck_assert_int_eq(300, bitset_find_next(bitset, 70));
+    bitset_resize(bitset, 0);
+    ck_assert_int_eq(0, bitset_count(bitset));
+    ck_assert_int_eq(0, bitset_find_first(bitset));
+    bitset_resize(bitset, 10);
+    ck_assert(!bitset_any(bitset));
+
+    bitset_reset_all(bitset);
+    ck_assert(!bitset_any(bitset));
+
+    bitset_free(bitset);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_set_ops) {
+    bitset_t *multiples_of_2 = bitset_new(1000);
+    bitset_t *multiples_of_3 = bitset_new(1000);
+    bitset_t *result;
+
+    for (size_t i = 0; i < 1000; i += 2) bitset_set(multiples_of_2, i);
+    for (size_t i = 0; i < 1000; i += 3) bitset_set(multiples_of_3, i);
+
+    result = bitset_clone(multiples_of_2);
+    ck_assert(bitset_equals(result, multiples_of_2));
+    bitset_and(result, multiples_of_3);
+    ck_assert_int_eq(167, bitset_count(result));     // 6的倍数
+    for (size_t i = bitset_find_first(result); i < 1000; i = bitset_find_next(result, i + 1)) {
+        ck_assert_int_eq(0, i % 6);
+    }
+
+    bitset_or(result, multiples_of_2);
+    ck_assert(bitset_equals(result, multiples_of_2));
+    bitset_or(result, multiples_of_3);
+    ck_assert_int_eq(667, bitset_count(result));
+
+    bitset_andnot(result, multiples_of_3);
+    ck_assert_int_eq(333, bitset_count(result));     // 是2的倍数但不是3的倍数
+    ck_assert(!bitset_test(result, 6) && bitset_test(result, 4));
+
+    bitset_xor(result, multiples_of_2);
+    ck_assert_int_eq(167, bitset_count(result));
+    ck_assert(!bitset_equals(result, multiples_of_2));
+
+    bitset_free(result);
+    bitset_free(multiples_of_2);
+    bitset_free(multiples_of_3);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_DEFINE_SUITE(bitset)
+    TEST(test_bits)
+    TEST(test_ranges)
+    TEST(test_set_ops)
+END_DEFINE_SUITE()
@@ -0,0 +1,149 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 18:02:37
+*/
+#include <check_util.h>
+
+#include "deque.h"
+#include "leak.h"
+#include "test_common.h"
+
+START_TEST(test_push_pop) {
+    deque_t *deque = deque_new(sizeof(int), NULL);
+    int value;
+
+    ck_assert(deque_empty(deque));
+    ck_assert(deque_front(deque) == NULL);
+    ck_assert(deque_back(deque) == NULL);
+    ck_assert_int_eq(8, deque_capacity(deque));
+
+    // 两端交替插入，结果是 -100 ... -1 0 ... 99
+    for (int i = 0; i < 100; i++) {
+        deque_push_back(deque, &i);
+        value = -(i + 1);
+        deque_push_front(deque, &value);
+    }
+    ck_assert_int_eq(200, deque_size(deque));
+    ck_assert_int_eq(256, deque_capacity(deque));
+    ck_assert_int_eq(-100, *(int*)deque_front(deque));
+    ck_assert_int_eq(99, *(int*)deque_back(deque));
+    for (int i = 0; i < 200; i++) {
+        ck_assert_int_eq(i - 100, *(int*)deque_get(deque, i));
+    }
+    ck_assert(deque_get(deque, 200) == NULL);
+
+    deque_pop_front(deque, &value);
+    ck_assert_int_eq(-100, value);
+    deque_pop_back(deque, &value);
+    ck_assert_int_eq(99, value);
+    deque_pop_back(deque, NULL);
+    ck_assert_int_eq(197, deque_size(deque));
+    ck_assert_int_eq(-99, *(int*)deque_front(deque));
+    ck_assert_int_eq(97, *(int*)deque_back(deque));
+
+    value = 1000;
+    deque_set(deque, 1, &value);
+    ck_assert_int_eq(1000, *(int*)deque_get(deque, 1));
+
+    deque_clear(deque);
+    ck_assert(deque_empty(deque));
+
+    deque_free(deque);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_queue) {
+    deque_t *deque = deque_new(sizeof(int), NULL);
+    int value, expect = 0, next = 0;
+
+    // 作为工作队列使用，元素数目在10个左右，缓冲区不停地环绕，但是不会增长
+    for (int round = 0; round < 10000; round++) {
+        deque_push_back(deque, &next);
+        ++ next;
+        if (round % 3 != 0 || deque_size(deque) > 6) {
+            deque_pop_front(deque, &value);
+            ck_assert_int_eq(expect, value);
+            ++ expect;
+        }
+    }
+    ck_assert_int_eq(8, deque_capacity(deque));
+
+    // 在环绕的状态下扩容，元素的顺序不变
+    while (deque_size(deque) < 100) {
+        deque_push_back(deque, &next);
+        ++ next;
+    }
+    for (size_t i = 0; i < deque_size(deque); i++) {
+        ck_assert_int_eq(expect + (int)i, *(int*)deque_get(deque, i));
+    }
+    deque_reserve(deque, 1000);
+    ck_assert_int_eq(1024, deque_capacity(deque));
+    while (!deque_empty(deque)) {
+        deque_pop_front(deque, &value);
+        ck_assert_int_eq(expect, value);
+        ++ expect;
+    }
+    ck_assert_int_eq(next, expect);
+
+    deque_free(deque);
+    ck_assert_no_leak();
+}
+END_TEST
+
+static void
+__int_ptr_destroy(void *value)
+{
+    cstl_free(*(int**)value);
+}
+
+static void
+__sum(void *value, void *user_data)
+{
+    *(int*)user_data += **(int**)value;
+}
+
+START_TEST(test_destroy) {
+    deque_t *deque = deque_new_with_capacity(sizeof(int*), __int_ptr_destroy, 3);
+    int *ptr;
+    int sum = 0;
+
+    ck_assert_int_eq(8, deque_capacity(deque));
+
+    for (int i = 1; i <= 20; i++) {
+        ptr = (int*)cstl_malloc(sizeof(int));
+        *ptr = i;
+        if (i % 2) {
+            deque_push_front(deque, &ptr);
+        } else {
+            deque_push_back(deque, &ptr);
+        }
+    }
+    deque_foreach(deque, __sum, &sum);
+    ck_assert_int_eq(210, sum);
+
+    // 取出的元素由调用者释放
+    deque_pop_front(deque, &ptr);
+    ck_assert_int_eq(19, *ptr);
+    cstl_free(ptr);
+
+    // 其余的由deque销毁
+    deque_pop_back(deque, NULL);
+    ptr = (int*)cstl_malloc(sizeof(int));
+    deque_set(deque, 0, &ptr);
+    deque_clear(deque);
+
+    ptr = (int*)cstl_malloc(sizeof(int));
+    deque_push_back(deque, &ptr);
+    deque_free(deque);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_DEFINE_SUITE(deque)
+    TEST(test_push_pop)
+    TEST(test_queue)
+    TEST(test_destroy)
+END_DEFINE_SUITE()
@@ -0,0 +1,223 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 17:20:46
+*/
+#include <check_util.h>
+
+#include "heap.h"
+#include "leak.h"
+#include "test_common.h"
+
+static int
+__int_cmp(const void *lhs, const void *rhs)
+{
+    int a = *(const int*)lhs, b = *(const int*)rhs;
+    return (a > b) - (a < b);
+}
+
+static int
+__int_reverse_cmp(const void *lhs, const void *rhs)
+{
+    return __int_cmp(rhs, lhs);
+}
+
+START_TEST(test_push_pop) {
+    heap_t *heap = heap_new(sizeof(int), __int_cmp, NULL);
+    int value;
+
+    ck_assert(heap_empty(heap));
+    ck_assert(heap_top(heap) == NULL);
+
+    // 乱序插入0~999，每个数插入两次
+    for (int i = 0; i < 2000; i++) {
+        value = (i * 7919) % 1000;
+        heap_push(heap, &value);
+    }
+    ck_assert_int_eq(2000, heap_size(heap));
+    ck_assert_int_eq(0, *(int*)heap_top(heap));
+
+    for (int i = 0; i < 2000; i++) {
+        ck_assert_int_eq(i / 2, *(int*)heap_top(heap));
+        heap_pop(heap, &value);
+        ck_assert_int_eq(i / 2, value);
+    }
+    ck_assert(heap_empty(heap));
+
+    // 保留最大的10个数：容量为10的最小堆，新的数比堆顶大就替换堆顶
+    for (int i = 0; i < 1000; i++) {
+        value = (i * 7919) % 1000;
+        if (heap_size(heap) < 10) {
+            heap_push(heap, &value);
+        } else if (value > *(int*)heap_top(heap)) {
+            heap_replace_top(heap, &value, NULL);
+        }
+    }
+    for (int i = 990; i < 1000; i++) {
+        heap_pop(heap, &value);
+        ck_assert_int_eq(i, value);
+    }
+
+    heap_free(heap);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_new_from_vec) {
+    for (int len = 0; len <= 40; len++) {
+        VEC *vec = int_vec_new();
+        heap_t *heap;
+        int value;
+
+        for (int i = 0; i < len; i++) {
+            int_vec_push_back(vec, (i * 71) % (len + 1));
+        }
+
+        // 最大堆
+        heap = heap_new_from_vec(vec, __int_reverse_cmp);
+        ck_assert_int_eq(len, heap_size(heap));
+        ck_assert(heap_data(heap) == vec);
+
+        for (int i = 0; i < len; i++) {
+            heap_pop(heap, &value);
+            // 0~len中缺少的那个数是(len * 71) % (len + 1)
+            ck_assert_int_eq(len - i - (len - i <= (len * 71) % (len + 1)), value);
+        }
+        ck_assert(heap_empty(heap));
+        heap_free(heap);
+    }
+    ck_assert_no_leak();
+}
+END_TEST
+
+typedef struct {
+    int deadline;
+    size_t heap_index;
+} timer_entry_t;
+
+static int
+__timer_cmp(const void *lhs, const void *rhs)
+{
+    return __int_cmp(&(*(timer_entry_t* const*)lhs)->deadline, &(*(timer_entry_t* const*)rhs)->deadline);
+}
+
+static void
+__timer_set_index(void *value, size_t index)
+{
+    (*(timer_entry_t**)value)->heap_index = index;
+}
+
+static void
+__check_indexes(heap_t *heap)
+{
+    for (size_t i = 0; i < heap_size(heap); i++) {
+        ck_assert((*(timer_entry_t**)heap_get(heap, i))->heap_index == i);
+    }
+}
+
+START_TEST(test_index_handle) {
+    heap_t *heap = heap_new(sizeof(timer_entry_t*), __timer_cmp, NULL);
+    timer_entry_t timers[100];
+    timer_entry_t *timer;
+
+    for (int i = 0; i < 50; i++) {
+        timers[i].deadline = 1000 + (i * 37) % 100;
+        timer = &timers[i];
+        heap_push(heap, &timer);
+    }
+    // 在设置回调之前插入的元素也会被通知
+    heap_set_index_func(heap, __timer_set_index);
+    __check_indexes(heap);
+
+    for (int i = 50; i < 100; i++) {
+        timers[i].deadline = 1000 + (i * 37) % 100;
+        timer = &timers[i];
+        heap_push(heap, &timer);
+    }
+    __check_indexes(heap);
+
+    // 提前timers[10]，变成最早的定时器
+    timers[10].deadline = 1;
+    timer = &timers[10];
+    heap_decrease_key(heap, timers[10].heap_index, &timer);
+    __check_indexes(heap);
+    ck_assert(*(timer_entry_t**)heap_top(heap) == &timers[10]);
+
+    // 推迟timers[10]，变成最晚的定时器
+    timers[10].deadline = 5000;
+    heap_update(heap, timers[10].heap_index);
+    __check_indexes(heap);
+
+    // 取消timers[20]
+    heap_remove(heap, timers[20].heap_index, &timer);
+    ck_assert(timer == &timers[20]);
+    __check_indexes(heap);
+    ck_assert_int_eq(99, heap_size(heap));
+
+    // 剩下的定时器按照时间顺序触发
+    for (int i = 0, prev = 0; i < 99; i++) {
+        heap_pop(heap, &timer);
+        ck_assert(timer != &timers[20]);
+        ck_assert(timer->deadline >= prev);
+        prev = timer->deadline;
+        __check_indexes(heap);
+    }
+    ck_assert(timer == &timers[10]);
+
+    heap_free(heap);
+    ck_assert_no_leak();
+}
+END_TEST
+
+static int
+__int_ptr_cmp(const void *lhs, const void *rhs)
+{
+    return __int_cmp(*(int* const*)lhs, *(int* const*)rhs);
+}
+
+static void
+__int_ptr_destroy(void *value)
+{
+    cstl_free(*(int**)value);
+}
+
+START_TEST(test_destroy) {
+    heap_t *heap = heap_new(sizeof(int*), __int_ptr_cmp, __int_ptr_destroy);
+    int *ptr;
+
+    for (int i = 0; i < 20; i++) {
+        ptr = (int*)cstl_malloc(sizeof(int));
+        *ptr = 20 - i;
+        heap_push(heap, &ptr);
+    }
+
+    // 取出的元素由调用者释放
+    heap_pop(heap, &ptr);
+    ck_assert_int_eq(1, *ptr);
+    cstl_free(ptr);
+
+    // 不取出的元素由heap销毁
+    heap_pop(heap, NULL);
+    heap_remove(heap, 5, NULL);
+    ptr = (int*)cstl_malloc(sizeof(int));
+    *ptr = 100;
+    heap_replace_top(heap, &ptr, NULL);
+    ck_assert_int_eq(17, heap_size(heap));
+
+    heap_clear(heap);
+    ck_assert(heap_empty(heap));
+
+    ptr = (int*)cstl_malloc(sizeof(int));
+    heap_push(heap, &ptr);
+    heap_free(heap);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_DEFINE_SUITE(heap)
+    TEST(test_push_pop)
+    TEST(test_new_from_vec)
+    TEST(test_index_handle)
+    TEST(test_destroy)
+END_DEFINE_SUITE()
@@ -9,6 +9,7 @@
 #include <assert.h>
 
 #include "hmap.h"
+#include "str.h"
 #include "test_common.h"
 
 START_TEST(test_create) {
@@ -289,6 +290,48 @@ START_TEST(test_destroy) {
 }
 END_TEST
 
+START_TEST(test_get_with) {
+    HMAP *hmap = hmap_new_with_destroy_func(sizeof(str_t*), sizeof(int),
+            (hash_func_t)str_ptr_hash_code,
+            (cmp_func_t)str_ptr_cmp,
+            (destroy_func_t)str_ptr_destroy,
+            NULL);
+    const char *names[] = {"user", "order", "item", "items", "ab", "ba"};
+    const char *path = "/order/items/42";
+    str_slice_t probe;
+
+    for (int i = 0; i < ARRAY_SIZE(names, const char*); i++) {
+        str_t *key = str_new_from(names[i]);
+        hmap_insert(hmap, &key, &i);
+    }
+
+    // 不用分配str_t就可以查找
+    probe = str_slice(path + 1, 5);
+    ck_assert_int_eq(1, *(int*)hmap_get_with(hmap, &probe,
+                (hash_func_t)str_slice_hash_code, (cmp_func_t)str_slice_ptr_cmp));
+
+    probe = str_slice(path + 7, 5);
+    ck_assert_int_eq(3, *(int*)hmap_get_with(hmap, &probe,
+                (hash_func_t)str_slice_hash_code, (cmp_func_t)str_slice_ptr_cmp));
+
+    // hash值相同，但是内容不同
+    probe = str_slice("ba", 2);
+    ck_assert_int_eq(5, *(int*)hmap_get_with(hmap, &probe,
+                (hash_func_t)str_slice_hash_code, (cmp_func_t)str_slice_ptr_cmp));
+
+    probe = str_slice(path + 7, 4);
+    ck_assert_int_eq(2, *(int*)hmap_get_with(hmap, &probe,
+                (hash_func_t)str_slice_hash_code, (cmp_func_t)str_slice_ptr_cmp));
+
+    probe = str_slice(path + 7, 3);
+    ck_assert(hmap_get_with(hmap, &probe, (hash_func_t)str_slice_hash_code,
+                (cmp_func_t)str_slice_ptr_cmp) == NULL);
+
+    hmap_free(hmap);
+    ck_assert_no_leak();
+}
+END_TEST
+
 START_DEFINE_SUITE(hmap)
     TEST(test_create)
     TEST(test_insert_erase_size)
@@ -298,4 +341,5 @@ START_DEFINE_SUITE(hmap)
     TEST(test_arr_key)
     TEST(test_erase_clear)
     TEST(test_destroy)
+    TEST(test_get_with)
 END_DEFINE_SUITE()
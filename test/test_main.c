@@ -8,6 +8,11 @@
 
 DECLARE_SUITE(leak);
 DECLARE_SUITE(vec);
+DECLARE_SUITE(vec_num);
+DECLARE_SUITE(heap);
+DECLARE_SUITE(deque);
+DECLARE_SUITE(ring_queue);
+DECLARE_SUITE(bitset);
 DECLARE_SUITE(hmap);
 DECLARE_SUITE(hset);
 DECLARE_SUITE(str);
@@ -16,6 +21,7 @@ DECLARE_SUITE(str_conv);
 DECLARE_SUITE(u8_str);
 DECLARE_SUITE(list);
 DECLARE_SUITE(rmap);
+DECLARE_SUITE(prmap);
 
 
 // 使用END_CHECK_MAIN_AFTER来当所有测试都结束的时候，执行检测操作
@@ -27,6 +33,11 @@ DECLARE_SUITE(rmap);
 START_CHECK_MAIN(cstl)
     SUITE(leak)
     SUITE(vec)
+    SUITE(vec_num)
+    SUITE(heap)
+    SUITE(deque)
+    SUITE(ring_queue)
+    SUITE(bitset)
     SUITE(hmap)
     SUITE(hset)
     SUITE(str)
@@ -35,5 +46,6 @@ START_CHECK_MAIN(cstl)
     SUITE(u8_str)
     SUITE(list)
     SUITE(rmap)
+    SUITE(prmap)
 END_CHECK_MAIN()
 
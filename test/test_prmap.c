@@ -0,0 +1,282 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 10:12:40
+*/
+#include <check_util.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "prmap.h"
+#include "test_common.h"
+
+START_TEST(test_create) {
+    prmap_t *pmap = prmap_new(sizeof(int), sizeof(int), CSTL_NUM_CMP_FUNC(int));
+    int key = 1;
+
+    ck_assert_int_eq(0, prmap_size(pmap));
+    ck_assert(prmap_empty(pmap));
+    ck_assert(prmap_get(pmap, &key) == NULL);
+    prmap_free(pmap);
+
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_insert_snapshot) {
+    prmap_t *v0 = prmap_new(sizeof(int), sizeof(int), CSTL_NUM_CMP_FUNC(int));
+    prmap_t *v1, *v2, *v3;
+    int key = 1, val = 10;
+
+    v1 = prmap_insert(v0, &key, &val);
+    key = 2; val = 20;
+    v2 = prmap_insert(v1, &key, &val);
+
+    // 覆盖已经存在的key
+    key = 1; val = 11;
+    v3 = prmap_insert(v2, &key, &val);
+
+    // 老的快照不会被修改
+    ck_assert_int_eq(0, prmap_size(v0));
+    ck_assert_int_eq(1, prmap_size(v1));
+    ck_assert_int_eq(2, prmap_size(v2));
+    ck_assert_int_eq(2, prmap_size(v3));
+
+    key = 1;
+    ck_assert_int_eq(10, *(const int*)prmap_get(v1, &key));
+    ck_assert_int_eq(10, *(const int*)prmap_get(v2, &key));
+    ck_assert_int_eq(11, *(const int*)prmap_get(v3, &key));
+
+    key = 2;
+    ck_assert(!prmap_has_key(v1, &key));
+    ck_assert(prmap_has_key(v2, &key));
+
+    // 释放的顺序没有要求
+    prmap_free(v1);
+    prmap_free(v3);
+    prmap_free(v0);
+    ck_assert_int_eq(20, *(const int*)prmap_get(v2, &key));
+    prmap_free(v2);
+
+    ck_assert_no_leak();
+}
+END_TEST
+
+static void
+__collect(const int *key, const int *value, int *out)
+{
+    ck_assert_int_eq(*key * 10, *value);
+    out[++out[0]] = *key;
+}
+
+START_TEST(test_erase_for_each) {
+    prmap_t *pmap = prmap_new(sizeof(int), sizeof(int), CSTL_NUM_CMP_FUNC(int));
+    prmap_t *next, *old;
+    int keys[1001];
+    int key, val, lo, hi;
+
+    // 乱序插入0~999
+    for (int i = 0; i < 1000; i++) {
+        key = (i * 7919) % 1000;
+        val = key * 10;
+        next = prmap_insert(pmap, &key, &val);
+        prmap_free(pmap);
+        pmap = next;
+    }
+    ck_assert_int_eq(1000, prmap_size(pmap));
+
+    // 删除所有的奇数，保留删除之前的快照
+    old = prmap_ref(pmap);
+    for (int i = 1; i < 1000; i += 2) {
+        next = prmap_erase(pmap, &i);
+        prmap_free(pmap);
+        pmap = next;
+    }
+    key = 5000;
+    next = prmap_erase(pmap, &key); //不存在的key
+    prmap_free(pmap);
+    pmap = next;
+    ck_assert_int_eq(500, prmap_size(pmap));
+    ck_assert_int_eq(1000, prmap_size(old));
+
+    keys[0] = 0;
+    prmap_for_each(pmap, (PRMAP_FOR_EACH)__collect, keys);
+    ck_assert_int_eq(500, keys[0]);
+    for (int i = 1; i <= 500; i++) {
+        ck_assert_int_eq((i - 1) * 2, keys[i]);
+    }
+
+    keys[0] = 0;
+    prmap_for_each(old, (PRMAP_FOR_EACH)__collect, keys);
+    ck_assert_int_eq(1000, keys[0]);
+    for (int i = 1; i <= 1000; i++) {
+        ck_assert_int_eq(i - 1, keys[i]);
+    }
+
+    // 范围遍历[lo, hi]
+    lo = 101; hi = 110;
+    keys[0] = 0;
+    prmap_for_each_range(pmap, &lo, &hi, (PRMAP_FOR_EACH)__collect, keys);
+    ck_assert_int_eq(5, keys[0]);
+    ck_assert_int_eq(102, keys[1]);
+    ck_assert_int_eq(110, keys[5]);
+
+    lo = 2000; hi = 3000;
+    keys[0] = 0;
+    prmap_for_each_range(pmap, &lo, &hi, (PRMAP_FOR_EACH)__collect, keys);
+    ck_assert_int_eq(0, keys[0]);
+
+    prmap_free(old);
+    prmap_free(pmap);
+    ck_assert_no_leak();
+}
+END_TEST
+
+#define READER_COUNT 4
+#define WRITE_COUNT 2000
+
+typedef struct {
+    prmap_cell_t *cell;
+    int done;
+} shared_t;
+
+static void
+__check_prefix(const int *key, const int *value, int *expect)
+{
+    // 每个快照中的key都是从0开始连续的
+    if (*key != *expect || *value != *key) {
+        *expect = -1000000;
+    }
+    ++ *expect;
+}
+
+static void *
+__reader(void *arg)
+{
+    shared_t *shared = (shared_t*)arg;
+    long errors = 0;
+
+    while (!__atomic_load_n(&shared->done, __ATOMIC_ACQUIRE)) {
+        prmap_t *snapshot = prmap_cell_acquire(shared->cell);
+        int expect = 0;
+
+        prmap_for_each(snapshot, (PRMAP_FOR_EACH)__check_prefix, &expect);
+        if (expect != (int)prmap_size(snapshot)) {
+            ++ errors;
+        }
+        prmap_free(snapshot);
+    }
+    return (void*)errors;
+}
+
+START_TEST(test_cell_concurrent) {
+    shared_t shared;
+    pthread_t readers[READER_COUNT];
+    prmap_t *current;
+
+    shared.cell = prmap_cell_new(prmap_new(sizeof(int), sizeof(int), CSTL_NUM_CMP_FUNC(int)));
+    shared.done = 0;
+
+    for (int i = 0; i < READER_COUNT; i++) {
+        pthread_create(&readers[i], NULL, __reader, &shared);
+    }
+
+    // 写线程不断生成新的快照并发布
+    for (int i = 0; i < WRITE_COUNT; i++) {
+        current = prmap_cell_acquire(shared.cell);
+        prmap_t *next = prmap_insert(current, &i, &i);
+        prmap_free(current);
+        prmap_cell_publish(shared.cell, next);
+    }
+    __atomic_store_n(&shared.done, 1, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < READER_COUNT; i++) {
+        void *errors;
+        pthread_join(readers[i], &errors);
+        ck_assert(errors == NULL);
+    }
+
+    current = prmap_cell_acquire(shared.cell);
+    ck_assert_int_eq(WRITE_COUNT, prmap_size(current));
+    prmap_free(current);
+
+    prmap_cell_free(shared.cell);
+    ck_assert_no_leak();
+}
+END_TEST
+
+#define BUSY_READER_COUNT 8
+
+static void *
+__busy_reader(void *arg)
+{
+    shared_t *shared = (shared_t*)arg;
+    size_t last_size = 0;
+    long acquired = 0;
+
+    // 不停地获取和释放引用，看到的快照只会越来越新
+    do {
+        prmap_t *snapshot = prmap_cell_acquire(shared->cell);
+        if (prmap_size(snapshot) < last_size) {
+            prmap_free(snapshot);
+            return (void*)-1L;
+        }
+        last_size = prmap_size(snapshot);
+        prmap_free(snapshot);
+        ++ acquired;
+    } while (!__atomic_load_n(&shared->done, __ATOMIC_ACQUIRE));
+    return (void*)acquired;
+}
+
+START_TEST(test_cell_publish_progress) {
+    shared_t shared;
+    pthread_t readers[BUSY_READER_COUNT];
+    prmap_t *current;
+    struct timespec beg, end;
+    double elapsed;
+
+    current = prmap_new(sizeof(int), sizeof(int), CSTL_NUM_CMP_FUNC(int));
+    shared.cell = prmap_cell_new(prmap_ref(current));
+    shared.done = 0;
+
+    for (int i = 0; i < BUSY_READER_COUNT; i++) {
+        pthread_create(&readers[i], NULL, __busy_reader, &shared);
+    }
+
+    // 读线程一直在获取引用，写线程的发布不能被它们阻塞
+    clock_gettime(CLOCK_MONOTONIC, &beg);
+    for (int i = 0; i < WRITE_COUNT; i++) {
+        prmap_t *next = prmap_insert(current, &i, &i);
+        prmap_free(current);
+        current = next;
+        prmap_cell_publish(shared.cell, prmap_ref(current));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    __atomic_store_n(&shared.done, 1, __ATOMIC_RELEASE);
+    prmap_free(current);
+
+    for (int i = 0; i < BUSY_READER_COUNT; i++) {
+        void *acquired;
+        pthread_join(readers[i], &acquired);
+        ck_assert((long)acquired > 0);
+    }
+    elapsed = (end.tv_sec - beg.tv_sec) + (end.tv_nsec - beg.tv_nsec) / 1e9;
+    ck_assert(elapsed < 5.0);
+
+    current = prmap_cell_acquire(shared.cell);
+    ck_assert_int_eq(WRITE_COUNT, prmap_size(current));
+    prmap_free(current);
+
+    prmap_cell_free(shared.cell);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_DEFINE_SUITE(prmap)
+    TEST(test_create)
+    TEST(test_insert_snapshot)
+    TEST(test_erase_for_each)
+    TEST(test_cell_concurrent)
+    TEST(test_cell_publish_progress)
+END_DEFINE_SUITE()
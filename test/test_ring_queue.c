@@ -0,0 +1,266 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 18:40:15
+*/
+#include <check_util.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "ring_queue.h"
+#include "leak.h"
+#include "test_common.h"
+
+START_TEST(test_spsc_basic) {
+    spsc_queue_t *queue = spsc_queue_new(sizeof(int), NULL, 5);
+    int values[10], value;
+
+    ck_assert_int_eq(8, spsc_queue_capacity(queue));
+    ck_assert(!spsc_queue_pop(queue, &value));
+
+    for (int i = 0; i < 8; i++) {
+        ck_assert(spsc_queue_push(queue, &i));
+    }
+    value = 8;
+    ck_assert(!spsc_queue_push(queue, &value));
+    ck_assert_int_eq(8, spsc_queue_size(queue));
+
+    // 批量操作跨过缓冲区的末尾
+    ck_assert_int_eq(5, spsc_queue_pop_batch(queue, values, 5));
+    for (int i = 0; i < 5; i++) {
+        values[i] = 8 + i;
+    }
+    ck_assert_int_eq(5, spsc_queue_push_batch(queue, values, 10));
+    ck_assert_int_eq(8, spsc_queue_pop_batch(queue, values, 10));
+    for (int i = 0; i < 8; i++) {
+        ck_assert_int_eq(5 + i, values[i]);
+    }
+    ck_assert_int_eq(0, spsc_queue_size(queue));
+    ck_assert_int_eq(0, spsc_queue_pop_batch(queue, values, 10));
+
+    spsc_queue_free(queue);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_mpmc_basic) {
+    mpmc_queue_t *queue = mpmc_queue_new(sizeof(int), NULL, 1);
+    int values[10], value;
+
+    ck_assert_int_eq(2, mpmc_queue_capacity(queue));
+    mpmc_queue_free(queue);
+
+    queue = mpmc_queue_new(sizeof(int), NULL, 8);
+    ck_assert(!mpmc_queue_pop(queue, &value));
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 8; i++) {
+            ck_assert(mpmc_queue_push(queue, &i));
+        }
+        ck_assert(!mpmc_queue_push(queue, &value));
+        ck_assert_int_eq(8, mpmc_queue_size(queue));
+
+        ck_assert_int_eq(3, mpmc_queue_pop_batch(queue, values, 3));
+        ck_assert_int_eq(2, values[2]);
+        for (int i = 0; i < 10; i++) {
+            values[i] = 100 + i;
+        }
+        ck_assert_int_eq(3, mpmc_queue_push_batch(queue, values, 10));
+        ck_assert_int_eq(8, mpmc_queue_pop_batch(queue, values, 10));
+        ck_assert_int_eq(3, values[0]);
+        ck_assert_int_eq(7, values[4]);
+        ck_assert_int_eq(102, values[7]);
+        ck_assert_int_eq(0, mpmc_queue_size(queue));
+    }
+
+    mpmc_queue_free(queue);
+    ck_assert_no_leak();
+}
+END_TEST
+
+static void
+__int_ptr_destroy(void *value)
+{
+    cstl_free(*(int**)value);
+}
+
+START_TEST(test_destroy) {
+    spsc_queue_t *spsc = spsc_queue_new(sizeof(int*), __int_ptr_destroy, 4);
+    mpmc_queue_t *mpmc = mpmc_queue_new(sizeof(int*), __int_ptr_destroy, 4);
+    int *ptr;
+
+    // 释放队列的时候销毁没有出队的元素
+    for (int i = 0; i < 3; i++) {
+        ptr = (int*)cstl_malloc(sizeof(int));
+        spsc_queue_push(spsc, &ptr);
+        ptr = (int*)cstl_malloc(sizeof(int));
+        mpmc_queue_push(mpmc, &ptr);
+    }
+    spsc_queue_pop(spsc, &ptr);
+    cstl_free(ptr);
+    mpmc_queue_pop(mpmc, &ptr);
+    cstl_free(ptr);
+
+    spsc_queue_free(spsc);
+    mpmc_queue_free(mpmc);
+    ck_assert_no_leak();
+}
+END_TEST
+
+#define ITEM_COUNT 200000
+#define BATCH_SIZE 7
+
+static void *
+__spsc_producer(void *arg)
+{
+    spsc_queue_t *queue = (spsc_queue_t*)arg;
+    int batch[BATCH_SIZE];
+    int next = 0;
+
+    // 交替使用单个和批量入队
+    while (next < ITEM_COUNT) {
+        if (next % 2) {
+            if (spsc_queue_push(queue, &next)) {
+                ++ next;
+                continue;
+            }
+        } else {
+            size_t count = 0;
+            for (int i = 0; i < BATCH_SIZE && next + i < ITEM_COUNT; i++) {
+                batch[count++] = next + i;
+            }
+            count = spsc_queue_push_batch(queue, batch, count);
+            next += count;
+            if (count > 0) continue;
+        }
+        sched_yield();
+    }
+    return NULL;
+}
+
+START_TEST(test_spsc_threads) {
+    spsc_queue_t *queue = spsc_queue_new(sizeof(int), NULL, 64);
+    pthread_t producer;
+    int batch[BATCH_SIZE];
+    int expect = 0;
+
+    pthread_create(&producer, NULL, __spsc_producer, queue);
+
+    // 元素按照入队的顺序出队
+    while (expect < ITEM_COUNT) {
+        size_t count = spsc_queue_pop_batch(queue, batch, BATCH_SIZE);
+        if (count == 0) {
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            ck_assert_int_eq(expect, batch[i]);
+            ++ expect;
+        }
+    }
+    pthread_join(producer, NULL);
+    ck_assert_int_eq(0, spsc_queue_size(queue));
+
+    spsc_queue_free(queue);
+    ck_assert_no_leak();
+}
+END_TEST
+
+#define THREAD_COUNT 3
+
+typedef struct {
+    mpmc_queue_t *queue;
+    int id;
+    int remaining;          // 所有消费者共享，还需要出队的元素数目
+    long long sum;          // 出队元素的和
+    int last[THREAD_COUNT]; // 每个生产者上一次出队的序号
+    bool ordered;           // 同一个生产者的元素是否是按照顺序出队的
+} __mpmc_arg_t;
+
+static void *
+__mpmc_producer(void *arg)
+{
+    __mpmc_arg_t *shared = (__mpmc_arg_t*)arg;
+    int id = __atomic_fetch_add(&shared->id, 1, __ATOMIC_RELAXED);
+    int batch[BATCH_SIZE];
+
+    // 元素的低两位是生产者的编号，其余是序号
+    for (int seq = 0; seq < ITEM_COUNT / THREAD_COUNT; ) {
+        size_t count = 0;
+        for (int i = 0; i < BATCH_SIZE && seq + i < ITEM_COUNT / THREAD_COUNT; i++) {
+            batch[count++] = ((seq + i) << 2) | id;
+        }
+        count = mpmc_queue_push_batch(shared->queue, batch, count);
+        if (count == 0) sched_yield();
+        seq += count;
+    }
+    return NULL;
+}
+
+static void *
+__mpmc_consumer(void *arg)
+{
+    __mpmc_arg_t *shared = (__mpmc_arg_t*)arg;
+    int last[THREAD_COUNT] = {-1, -1, -1};
+    long long sum = 0;
+    bool ordered = true;
+    int value;
+
+    while (__atomic_load_n(&shared->remaining, __ATOMIC_RELAXED) > 0) {
+        if (!mpmc_queue_pop(shared->queue, &value)) {
+            sched_yield();
+            continue;
+        }
+        __atomic_sub_fetch(&shared->remaining, 1, __ATOMIC_RELAXED);
+        // 单个消费者看到的同一个生产者的元素一定是递增的
+        if ((value >> 2) <= last[value & 3]) ordered = false;
+        last[value & 3] = value >> 2;
+        sum += value >> 2;
+    }
+    __atomic_add_fetch(&shared->sum, sum, __ATOMIC_RELAXED);
+    if (!ordered) __atomic_store_n(&shared->ordered, false, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+START_TEST(test_mpmc_threads) {
+    __mpmc_arg_t shared;
+    pthread_t producers[THREAD_COUNT], consumers[THREAD_COUNT];
+    long long per_producer = ITEM_COUNT / THREAD_COUNT;
+
+    shared.queue = mpmc_queue_new(sizeof(int), NULL, 128);
+    shared.id = 0;
+    shared.remaining = per_producer * THREAD_COUNT;
+    shared.sum = 0;
+    shared.ordered = true;
+
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_create(&consumers[i], NULL, __mpmc_consumer, &shared);
+        pthread_create(&producers[i], NULL, __mpmc_producer, &shared);
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    // 每个元素恰好出队一次
+    ck_assert(shared.sum == per_producer * (per_producer - 1) / 2 * THREAD_COUNT);
+    ck_assert(shared.ordered);
+    ck_assert_int_eq(0, mpmc_queue_size(shared.queue));
+
+    mpmc_queue_free(shared.queue);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_DEFINE_SUITE(ring_queue)
+    TEST(test_spsc_basic)
+    TEST(test_mpmc_basic)
+    TEST(test_destroy)
+    TEST(test_spsc_threads)
+    TEST(test_mpmc_threads)
+END_DEFINE_SUITE()
+
+#undef THREAD_COUNT
+#undef BATCH_SIZE
+#undef ITEM_COUNT
@@ -7,6 +7,7 @@
 #include <check_util.h>
 
 #include "rmap.h"
+#include "str.h"
 #include "test_common.h"
 
 START_TEST(test_create) {
@@ -107,13 +108,12 @@ typedef struct {
 } data_cursor_t;
 
 static void
-__for_each(char *key, int *value, data_cursor_t __attribute__((unused)) *user_data)
+__for_each(char *key, int *value, data_cursor_t *user_data)
 {
-    //因为是无序的，不能使用那样测试，因为顺序不确定，不能按照先后顺序来进行测试
-    /*ck_assert_int_eq(*value, user_data->datas[user_data->pos].val);*/
-    /*ck_assert_int_eq(*key, user_data->datas[user_data->pos].key);*/
-    /*++ user_data->pos;*/
-    printf("rmap-> key=%c, value=%d\n", *key, *value);
+    // rmap_for_each是按照key从小到大的顺序进行遍历的
+    ck_assert_int_eq(*value, user_data->datas[user_data->pos].val);
+    ck_assert_int_eq(*key, user_data->datas[user_data->pos].key);
+    ++ user_data->pos;
 }
 
 START_TEST(test_for_each) {
@@ -126,14 +126,15 @@ START_TEST(test_for_each) {
         {.key='b', .val=98},
         {.key='c', .val=99}
     };
-    data_cursor_t UNUSED data_cursor = {.datas=expect_datas, .pos=0};
+    data_cursor_t data_cursor = {.datas=expect_datas, .pos=0};
 
+    key = 'c'; val = 99;
     rmap_insert(rmap, &key, &val);
 
-    key = 'b'; val = 98;
+    key = 'a'; val = 97;
     rmap_insert(rmap, &key, &val);
 
-    key = 'c'; val = 99;
+    key = 'b'; val = 98;
     rmap_insert(rmap, &key, &val);
 
     key = 'd';
@@ -141,6 +142,7 @@ START_TEST(test_for_each) {
     ck_assert(!rmap_has_key(rmap, &key));
 
     rmap_for_each(rmap, (RMAP_FOR_EACH)__for_each, &data_cursor);
+    ck_assert_int_eq(3, data_cursor.pos);
     rmap_free(rmap);
     ck_assert_no_leak();
 }
@@ -267,6 +269,145 @@ START_TEST(test_destroy) {
 }
 END_TEST
 
+START_TEST(test_get_or_insert) {
+    rmap_t *rmap = rmap_new(sizeof(int), sizeof(int), 
+             CSTL_NUM_CMP_FUNC(int));
+    bool inserted = false;
+    int key = 1, val = 100;
+
+    int *slot = (int*)rmap_get_or_insert(rmap, &key, &val, &inserted);
+    ck_assert(inserted);
+    ck_assert_int_eq(100, *slot);
+    ck_assert_int_eq(1, rmap_size(rmap));
+
+    // 已经存在的key不会被覆盖
+    val = 200;
+    slot = (int*)rmap_get_or_insert(rmap, &key, &val, &inserted);
+    ck_assert(!inserted);
+    ck_assert_int_eq(100, *slot);
+    ck_assert_int_eq(1, rmap_size(rmap));
+
+    // 可以通过返回的地址直接修改值
+    *slot += 1;
+    ck_assert_int_eq(101, *(int*)rmap_get(rmap, &key));
+
+    // inserted可以为NULL
+    key = 2;
+    slot = (int*)rmap_get_or_insert(rmap, &key, &val, NULL);
+    ck_assert_int_eq(200, *slot);
+    ck_assert_int_eq(2, rmap_size(rmap));
+
+    // insert对于已经存在的key会替换值
+    for (int i = 0; i < 1000; i++) {
+        key = i; val = i;
+        rmap_insert(rmap, &key, &val);
+    }
+    ck_assert_int_eq(1000, rmap_size(rmap));
+    for (int i = 0; i < 1000; i++) {
+        ck_assert_int_eq(i, *(int*)rmap_get(rmap, &i));
+    }
+
+    rmap_free(rmap);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_rank_select) {
+    rmap_t *rmap = rmap_new_with_rank(sizeof(int), sizeof(int), 
+             CSTL_NUM_CMP_FUNC(int), NULL, NULL);
+    const int n = 2000;
+    bool present[n];
+    int key, val, count;
+
+    // 乱序插入偶数key
+    srand(7);
+    memset(present, 0, sizeof(present));
+    for (int i = 0; i < n; i++) {
+        key = (rand() % (n / 2)) * 2;
+        val = key * 10;
+        rmap_insert(rmap, &key, &val);
+        present[key] = true;
+    }
+
+    // 删除其中一部分
+    for (int i = 0; i < n / 2; i++) {
+        key = (rand() % (n / 2)) * 2;
+        rmap_erase(rmap, &key);
+        present[key] = false;
+    }
+
+    count = 0;
+    for (int i = 0; i < n; i++) {
+        ck_assert_int_eq(count, rmap_rank(rmap, &i));
+        if (present[i]) {
+            void *value = NULL;
+            const int *k = (const int*)rmap_select(rmap, count, &value);
+            ck_assert(k != NULL);
+            ck_assert_int_eq(i, *k);
+            ck_assert_int_eq(i * 10, *(int*)value);
+            ++ count;
+        }
+    }
+    ck_assert_int_eq(count, rmap_size(rmap));
+    ck_assert(rmap_select(rmap, count, NULL) == NULL);
+
+    for (int lo = 0; lo < n; lo += 97) {
+        for (int hi = lo; hi < n; hi += 131) {
+            int expect = 0;
+            for (int i = lo; i <= hi; i++) {
+                if (present[i]) ++ expect;
+            }
+            ck_assert_int_eq(expect, rmap_count_range(rmap, &lo, &hi));
+        }
+    }
+    key = 10; val = 5;
+    ck_assert_int_eq(0, rmap_count_range(rmap, &key, &val));
+
+    rmap_clear(rmap);
+    key = 1;
+    ck_assert_int_eq(0, rmap_rank(rmap, &key));
+    ck_assert(rmap_select(rmap, 0, NULL) == NULL);
+
+    rmap_free(rmap);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_get_with) {
+    rmap_t *rmap = rmap_new_with_destroy_func(sizeof(str_t*), sizeof(int),
+            (cmp_func_t)str_ptr_cmp,
+            (destroy_func_t)str_ptr_destroy,
+            NULL);
+    const char *names[] = {"user", "order", "item", "items", "a", "zz"};
+    const char *path = "/order/items/42";
+    str_slice_t probe;
+
+    for (int i = 0; i < ARRAY_SIZE(names, const char*); i++) {
+        str_t *key = str_new_from(names[i]);
+        rmap_insert(rmap, &key, &i);
+    }
+
+    // 使用片段查找，不需要分配临时的str_t
+    probe = str_slice(path + 1, 5);
+    ck_assert_int_eq(1, *(int*)rmap_get_with(rmap, &probe, (cmp_func_t)str_slice_ptr_cmp));
+
+    probe = str_slice(path + 7, 5);
+    ck_assert_int_eq(3, *(int*)rmap_get_with(rmap, &probe, (cmp_func_t)str_slice_ptr_cmp));
+
+    probe = str_slice(path + 7, 4);
+    ck_assert_int_eq(2, *(int*)rmap_get_with(rmap, &probe, (cmp_func_t)str_slice_ptr_cmp));
+
+    probe = str_slice(path + 7, 3);
+    ck_assert(rmap_get_with(rmap, &probe, (cmp_func_t)str_slice_ptr_cmp) == NULL);
+
+    probe = str_slice("", 0);
+    ck_assert(rmap_get_with(rmap, &probe, (cmp_func_t)str_slice_ptr_cmp) == NULL);
+
+    rmap_free(rmap);
+    ck_assert_no_leak();
+}
+END_TEST
+
 START_DEFINE_SUITE(rmap)
     TEST(test_create)
     TEST(test_insert_erase_size)
@@ -276,4 +417,7 @@ START_DEFINE_SUITE(rmap)
     TEST(test_arr_key)
     TEST(test_erase_clear)
     TEST(test_destroy)
+    TEST(test_get_or_insert)
+    TEST(test_rank_select)
+    TEST(test_get_with)
 END_DEFINE_SUITE()
@@ -10,6 +10,7 @@
 #include <assert.h>
 
 #include "vec.h"
+#include "vec_num.h"
 #include "test_common.h"
 
 START_TEST(test_new) {
@@ -88,13 +89,123 @@ START_TEST(test_resize) {
     // 使用resize来扩大容量
     vec_resize(vec, 100, &default_value);
     ck_assert_int_eq(100, vec_size(vec));
-    ck_assert_int_eq(default_value, *(int*)vec_get(vec, 99));
+    for (int i = 6; i < 100; i++) {
+        ck_assert_int_eq(default_value, *(int*)vec_get(vec, i));
+    }
+    for (int i = 0; i < 6; i++) {
+        ck_assert_int_eq(datas[i], *(int*)vec_get(vec, i));
+    }
 
     vec_free(vec);
     ck_assert_no_leak();
 }
 END_TEST
 
+START_TEST(test_capacity) {
+    VEC *vec = vec_new_with_capacity(sizeof(int), NULL, 4);
+    int data = 7;
+    void *beg;
+
+    // reserve只会扩大容量
+    vec_reserve(vec, 100);
+    ck_assert_int_eq(100, vec_capacity(vec));
+    vec_reserve(vec, 10);
+    ck_assert_int_eq(100, vec_capacity(vec));
+
+    // 容量足够时候插入不会重新分配内存
+    beg = vec->beg;
+    for (int i = 0; i < 100; i++) {
+        vec_push_back(vec, &i);
+    }
+    ck_assert(beg == vec->beg);
+
+    // 保留容量的清空
+    vec_clear_keep_capacity(vec);
+    ck_assert_int_eq(0, vec_size(vec));
+    ck_assert_int_eq(100, vec_capacity(vec));
+    for (int i = 0; i < 50; i++) {
+        vec_push_back(vec, &i);
+    }
+    ck_assert(beg == vec->beg);
+
+    vec_shrink_to_fit(vec);
+    ck_assert_int_eq(50, vec_capacity(vec));
+    for (int i = 0; i < 50; i++) {
+        ck_assert_int_eq(i, *(int*)vec_get(vec, i));
+    }
+
+    // 自定义增长倍数
+    vec_set_growth_factor(vec, 1.5f);
+    vec_push_back(vec, &data);
+    ck_assert_int_eq(75, vec_capacity(vec));
+
+    // resize扩容时候也按照倍数增长
+    vec_resize(vec, 76, &data);
+    ck_assert_int_eq(112, vec_capacity(vec));
+
+    vec_clear_keep_capacity(vec);
+    vec_shrink_to_fit(vec);
+    ck_assert_int_eq(0, vec_capacity(vec));
+    vec_push_back(vec, &data);
+    ck_assert_int_eq(1, vec_size(vec));
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+DEFINE_SMALL_VEC(int, 4)
+
+START_TEST(test_small_vec) {
+    int_small_vec_t svec;
+    VEC *vec = int_small_vec_init(&svec);
+    VEC *heap_vec = vec_new_small(sizeof(int), NULL, 8);
+
+    // 没有超过内置存储的容量，不会分配内存
+    for (int i = 0; i < 4; i++) {
+        int_vec_push_back(vec, i);
+    }
+    ck_assert(vec->beg == svec.inline_data);
+    ck_assert_int_eq(4, vec_capacity(vec));
+    ck_assert_int_eq(3, svec.inline_data[3]);
+
+    // 超过之后搬移到堆上
+    for (int i = 4; i < 20; i++) {
+        int_vec_push_back(vec, i);
+    }
+    ck_assert(vec->beg != svec.inline_data);
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(i, *int_vec_get(vec, i));
+    }
+
+    // 元素变少之后可以回到内置存储上
+    vec_resize(vec, 3, NULL);
+    vec_shrink_to_fit(vec);
+    ck_assert(vec->beg == svec.inline_data);
+    ck_assert_int_eq(4, vec_capacity(vec));
+    ck_assert_int_eq(2, *int_vec_get(vec, 2));
+
+    vec_insert_array(vec, 0, svec.inline_data, 3);
+    vec_clear(vec);
+    ck_assert(vec->beg == svec.inline_data);
+    int_vec_push_back(vec, 5);
+    int_small_vec_deinit(&svec);
+
+    // 堆上的vec_t和内置存储只需要一次分配
+    for (int i = 0; i < 100; i++) {
+        int_vec_push_back(heap_vec, i);
+        ck_assert_int_eq(i, *int_vec_back(heap_vec));
+    }
+    int_vec_sort(heap_vec);
+    ck_assert_int_eq(99, *int_vec_get(heap_vec, 99));
+    vec_clear(heap_vec);
+    ck_assert_int_eq(8, vec_capacity(heap_vec));
+    vec_free(heap_vec);
+
+    ck_assert_no_leak();
+}
+END_TEST
+
 START_TEST(test_pop_front) {
     VEC *vec = vec_new(sizeof(int), NULL);
 
@@ -367,6 +478,53 @@ START_TEST(test_extend) {
 }
 END_TEST
 
+START_TEST(test_insert_array) {
+    VEC *vec = vec_new_with_capacity(sizeof(int), NULL, 2);
+    int datas[] = {1, 2, 3, 4, 5};
+    int expect[] = {1, 2, 1, 2, 3, 4, 5, 3, 4, 5};
+    int expect2[] = {1, 2, 1, 2, 3, 1, 2, 1, 2, 3, 4, 5, 3, 4, 5, 4, 5, 3, 4, 5};
+
+    // 追加到尾部，需要扩容
+    vec_append_array(vec, datas, 5);
+    ck_assert_int_eq(5, vec_size(vec));
+    for (int i = 0; i < 5; i++) {
+        ck_assert_int_eq(datas[i], *(int*)vec_get(vec, i));
+    }
+
+    // 插入到中间
+    vec_insert_array(vec, 2, datas, 5);
+    ck_assert_int_eq(ARRAY_SIZE(expect, int), vec_size(vec));
+    for (int i = 0; i < ARRAY_SIZE(expect, int); i++) {
+        ck_assert_int_eq(expect[i], *(int*)vec_get(vec, i));
+    }
+
+    // 插入vec自身的元素
+    vec_insert_array(vec, 5, vec_get(vec, 0), vec_size(vec));
+    ck_assert_int_eq(ARRAY_SIZE(expect2, int), vec_size(vec));
+    for (int i = 0; i < ARRAY_SIZE(expect2, int); i++) {
+        ck_assert_int_eq(expect2[i], *(int*)vec_get(vec, i));
+    }
+
+    // 插入到头部，以及超出范围的索引插入到尾部
+    vec_insert_array(vec, 0, &datas[4], 1);
+    vec_insert_array(vec, 1000, &datas[0], 1);
+    vec_insert_array(vec, 3, NULL, 0);
+    ck_assert_int_eq(22, vec_size(vec));
+    ck_assert_int_eq(5, *(int*)vec_front(vec));
+    ck_assert_int_eq(1, *(int*)vec_back(vec));
+
+    // 使用vec自身来扩展
+    vec_extend(vec, 0, vec);
+    ck_assert_int_eq(44, vec_size(vec));
+    for (int i = 0; i < 22; i++) {
+        ck_assert_int_eq(*(int*)vec_get(vec, i), *(int*)vec_get(vec, i + 22));
+    }
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
 START_TEST(test_assign) {
     VEC *vec = vec_new(sizeof(int), NULL);
     int data = 100;
@@ -519,6 +677,76 @@ START_TEST(test_remove_all) {
 }
 END_TEST
 
+static bool
+__is_multiple_of(const int *value, int *divisor)
+{
+    return *value % *divisor == 0;
+}
+
+static int destroy_count = 0;
+
+static void
+__count_destroy(int *value)
+{
+    ++ destroy_count;
+}
+
+START_TEST(test_batch_remove) {
+    VEC *vec = vec_new(sizeof(int), NULL);
+    VEC *dvec = vec_new(sizeof(int), (destroy_func_t)__count_destroy);
+    int divisor = 3;
+
+    for (int i = 0; i < 30; i++) {
+        vec_push_back(vec, &i);
+    }
+
+    // 删除所有3的倍数，剩下的元素保持原来的顺序
+    ck_assert_int_eq(10, vec_remove_if(vec, (vec_pred_func_t)__is_multiple_of, &divisor));
+    ck_assert_int_eq(20, vec_size(vec));
+    for (int i = 0, expect = 1; i < 20; i++, expect++) {
+        if (expect % 3 == 0) expect++;
+        ck_assert_int_eq(expect, *(int*)vec_get(vec, i));
+    }
+
+    // 删除[2, 5)，超出范围的to会被截断
+    vec_erase_range(vec, 2, 5);
+    ck_assert_int_eq(17, vec_size(vec));
+    ck_assert_int_eq(2, *(int*)vec_get(vec, 1));
+    ck_assert_int_eq(8, *(int*)vec_get(vec, 2));
+    vec_erase_range(vec, 5, 5);
+    vec_erase_range(vec, 15, 1000);
+    ck_assert_int_eq(15, vec_size(vec));
+
+    // 使用最后一个元素填补空位
+    vec_swap_remove(vec, 0);
+    ck_assert_int_eq(14, vec_size(vec));
+    ck_assert_int_eq(26, *(int*)vec_get(vec, 0));
+    vec_swap_remove(vec, 13);
+    ck_assert_int_eq(13, vec_size(vec));
+    vec_swap_remove(vec, 100);
+    ck_assert_int_eq(13, vec_size(vec));
+
+    // 被移除的元素都会调用destroy函数
+    for (int i = 0; i < 10; i++) {
+        vec_push_back(dvec, &i);
+    }
+    destroy_count = 0;
+    divisor = 2;
+    ck_assert_int_eq(5, vec_remove_if(dvec, (vec_pred_func_t)__is_multiple_of, &divisor));
+    vec_erase_range(dvec, 0, 2);
+    vec_swap_remove(dvec, 0);
+    ck_assert_int_eq(2, vec_size(dvec));
+    ck_assert_int_eq(9, *(int*)vec_get(dvec, 0));
+    ck_assert_int_eq(7, *(int*)vec_get(dvec, 1));
+    ck_assert_int_eq(8, destroy_count);
+
+    vec_free(vec);
+    vec_free(dvec);
+    ck_assert_int_eq(10, destroy_count);
+    ck_assert_no_leak();
+}
+END_TEST
+
 START_TEST(test_sort) {
     VEC *vec = vec_new(sizeof(int), NULL);
 
@@ -548,6 +776,633 @@ START_TEST(test_sort) {
 }
 END_TEST
 
+// 检查vec是否已经有序，并且所有元素的和没有改变
+static void
+__check_sorted(VEC *vec, long long sum)
+{
+    long long actual = 0;
+
+    for (size_t i = 0; i < vec_size(vec); i++) {
+        actual += *(int*)vec_get(vec, i);
+        if (i > 0) {
+            ck_assert(*(int*)vec_get(vec, i - 1) <= *(int*)vec_get(vec, i));
+        }
+    }
+    ck_assert(sum == actual);
+}
+
+START_TEST(test_sort_patterns) {
+    const int n = 20000;
+    VEC *vec = vec_new(sizeof(int), NULL);
+    unsigned seed = 12345;
+    long long sum;
+    int data;
+
+    // 已经有序、逆序、全部相等、只有少量不同值、锯齿、随机
+    for (int pattern = 0; pattern < 6; pattern++) {
+        vec_clear(vec);
+        sum = 0;
+        for (int i = 0; i < n; i++) {
+            seed = seed * 1103515245 + 12345;
+            switch (pattern) {
+                case 0: data = i; break;
+                case 1: data = n - i; break;
+                case 2: data = 7; break;
+                case 3: data = (seed >> 16) % 4; break;
+                case 4: data = i % 100; break;
+                default: data = (int)(seed >> 1); break;
+            }
+            sum += data;
+            vec_push_back(vec, &data);
+        }
+        vec_sort(vec, CSTL_NUM_CMP_FUNC(int));
+        __check_sorted(vec, sum);
+    }
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+// CSTL_NUM_CMP_FUNC使用减法比较，数值范围很大时会溢出，所以这里使用精确的比较函数
+static int
+__exact_int_cmp(const void *lhs, const void *rhs)
+{
+    int l = *(const int*)lhs, r = *(const int*)rhs;
+    return (l > r) - (l < r);
+}
+
+static int
+__exact_double_cmp(const void *lhs, const void *rhs)
+{
+    double l = *(const double*)lhs, r = *(const double*)rhs;
+    return (l > r) - (l < r);
+}
+
+START_TEST(test_radix_sort) {
+    VEC *ivec = int_vec_new(), *ivec2 = int_vec_new();
+    VEC *dvec = double_vec_new(), *dvec2 = double_vec_new();
+    VEC *uvec = unsigned_long_vec_new();
+    VEC *cvec = char_vec_new();
+    unsigned seed = 54321;
+
+    // 同时包含正数和负数，和vec_sort的结果比较
+    for (int i = 0; i < 5000; i++) {
+        seed = seed * 1103515245 + 12345;
+        int_vec_push_back(ivec, (int)seed);
+        int_vec_push_back(ivec2, (int)seed);
+        double_vec_push_back(dvec, ((int)seed) / 1000.0);
+        double_vec_push_back(dvec2, ((int)seed) / 1000.0);
+        unsigned_long_vec_push_back(uvec, (unsigned long)seed * seed);
+    }
+    double_vec_push_back(dvec, -0.5);
+    double_vec_push_back(dvec2, -0.5);
+
+    int_vec_radix_sort(ivec);
+    vec_sort(ivec2, __exact_int_cmp);
+    for (int i = 0; i < vec_size(ivec); i++) {
+        ck_assert_int_eq(*int_vec_get(ivec2, i), *int_vec_get(ivec, i));
+    }
+
+    double_vec_radix_sort(dvec);
+    vec_sort(dvec2, __exact_double_cmp);
+    for (int i = 0; i < vec_size(dvec); i++) {
+        ck_assert(*double_vec_get(dvec2, i) == *double_vec_get(dvec, i));
+    }
+
+    unsigned_long_vec_radix_sort(uvec);
+    for (int i = 1; i < vec_size(uvec); i++) {
+        ck_assert(*unsigned_long_vec_get(uvec, i - 1) <= *unsigned_long_vec_get(uvec, i));
+    }
+
+    // 少量元素
+    char_vec_push_back(cvec, 3);
+    char_vec_push_back(cvec, 1);
+    char_vec_push_back(cvec, 2);
+    char_vec_radix_sort(cvec);
+    for (int i = 0; i < 3; i++) {
+        ck_assert_int_eq(i + 1, *char_vec_get(cvec, i));
+    }
+
+    vec_free(ivec);
+    vec_free(ivec2);
+    vec_free(dvec);
+    vec_free(dvec2);
+    vec_free(uvec);
+    vec_free(cvec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_sort_parallel) {
+    const int n = 100000;
+    VEC *vec = vec_new(sizeof(int), NULL);
+    unsigned seed = 777;
+    long long sum = 0;
+    int data;
+    // 包括线程数目不是2的幂，以及自动检测cpu核心数目的情况
+    int thread_counts[] = {1, 2, 3, 5, 0};
+
+    for (int t = 0; t < ARRAY_SIZE(thread_counts, int); t++) {
+        vec_clear(vec);
+        sum = 0;
+        for (int i = 0; i < n; i++) {
+            seed = seed * 1103515245 + 12345;
+            data = (t % 2 == 0) ? (int)((seed >> 8) % 100000) : (int)((seed >> 16) % 10);
+            sum += data;
+            vec_push_back(vec, &data);
+        }
+        vec_sort_parallel(vec, CSTL_NUM_CMP_FUNC(int), thread_counts[t]);
+        __check_sorted(vec, sum);
+    }
+
+    // 元素很少时候退化为vec_sort
+    vec_clear(vec);
+    for (int i = 10; i > 0; i--) {
+        vec_push_back(vec, &i);
+    }
+    vec_sort_parallel(vec, CSTL_NUM_CMP_FUNC(int), 8);
+    __check_sorted(vec, 55);
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+static void
+__double_and_count(void *value, void *user_data)
+{
+    // 让一部分元素的耗时明显更长，先完成的线程需要去偷其他线程的块
+    if (*(int*)value % 4096 == 0) {
+        for (volatile int i = 0; i < 20000; i++) {}
+    }
+    *(int*)value *= 2;
+    __atomic_add_fetch((long*)user_data, 1, __ATOMIC_RELAXED);
+}
+
+static void
+__sum_ll(void *acc, const void *value, void *user_data)
+{
+    *(long long*)acc += *(const int*)value;
+}
+
+static void
+__sum_merge(void *acc, const void *other, void *user_data)
+{
+    *(long long*)acc += *(const long long*)other;
+}
+
+// 记录一段元素是否是严格递增的，用来检查部分结果是按照块的顺序合并的
+typedef struct {
+    long count;
+    int first;
+    int last;
+    bool ascending;
+} __run_info_t;
+
+static void
+__run_map(void *acc, const void *value, void *user_data)
+{
+    __run_info_t *info = (__run_info_t*)acc;
+    int v = *(const int*)value;
+
+    if (info->count == 0) {
+        info->first = v;
+    } else if (v <= info->last) {
+        info->ascending = false;
+    }
+    info->last = v;
+    ++ info->count;
+}
+
+static void
+__run_merge(void *acc, const void *other, void *user_data)
+{
+    __run_info_t *lhs = (__run_info_t*)acc;
+    const __run_info_t *rhs = (const __run_info_t*)other;
+
+    if (rhs->count == 0) return;
+    if (lhs->count == 0) {
+        *lhs = *rhs;
+        return;
+    }
+    lhs->ascending = lhs->ascending && rhs->ascending && lhs->last < rhs->first;
+    lhs->last = rhs->last;
+    lhs->count += rhs->count;
+}
+
+START_TEST(test_parallel_foreach_reduce) {
+    const int n = 200000;
+    VEC *vec = int_vec_new();
+    int thread_counts[] = {1, 2, 3, 7, 0};
+    long long zero = 0, sum;
+    __run_info_t empty = {0, 0, 0, true}, info;
+
+    for (int i = 0; i < n; i++) {
+        int_vec_push_back(vec, i);
+    }
+
+    for (int t = 0; t < ARRAY_SIZE(thread_counts, int); t++) {
+        long calls = 0;
+
+        vec_parallel_reduce(vec, __sum_ll, __sum_merge, &zero, &sum, sizeof(sum), NULL, thread_counts[t]);
+        ck_assert(sum == (long long)n * (n - 1) / 2 << t);
+
+        vec_parallel_reduce(vec, __run_map, __run_merge, &empty, &info, sizeof(info), NULL, thread_counts[t]);
+        ck_assert(info.ascending);
+        ck_assert_int_eq(n, info.count);
+        ck_assert_int_eq(0, info.first);
+
+        // 每个元素恰好被访问一次
+        vec_parallel_foreach(vec, __double_and_count, &calls, thread_counts[t]);
+        ck_assert_int_eq(n, calls);
+        ck_assert_int_eq(2 * (n - 1) << t, *int_vec_back(vec));
+    }
+
+    // 元素很少或者为空的时候在调用线程中完成
+    vec_clear(vec);
+    sum = 1;
+    vec_parallel_reduce(vec, __sum_ll, __sum_merge, &zero, &sum, sizeof(sum), NULL, 8);
+    ck_assert(sum == 0);
+    for (int i = 1; i <= 10; i++) {
+        int_vec_push_back(vec, i);
+    }
+    vec_parallel_reduce(vec, __sum_ll, __sum_merge, &zero, &sum, sizeof(sum), NULL, 8);
+    ck_assert(sum == 55);
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+typedef struct {
+    int key;
+    int seq;        // 插入的顺序
+} record_t;
+
+static int
+__record_key_cmp(const void *lhs, const void *rhs)
+{
+    return ((const record_t*)lhs)->key - ((const record_t*)rhs)->key;
+}
+
+START_TEST(test_stable_sort) {
+    VEC *vec = vec_new(sizeof(record_t), NULL);
+    unsigned seed = 2024;
+    record_t rec;
+
+    // 随机、有序的区间拼接、降序、少量元素，key都有大量重复
+    for (int pattern = 0; pattern < 4; pattern++) {
+        int n = (pattern == 3) ? 17 : 10000;
+
+        vec_clear(vec);
+        for (int i = 0; i < n; i++) {
+            seed = seed * 1103515245 + 12345;
+            switch (pattern) {
+                case 0: rec.key = (seed >> 16) % 100; break;
+                case 1: rec.key = (i % 1000) / 10; break;
+                case 2: rec.key = (n - i) / 3; break;
+                default: rec.key = (seed >> 16) % 5; break;
+            }
+            rec.seq = i;
+            vec_push_back(vec, &rec);
+        }
+
+        vec_stable_sort(vec, __record_key_cmp);
+
+        ck_assert_int_eq(n, vec_size(vec));
+        for (int i = 1; i < n; i++) {
+            record_t *prev = (record_t*)vec_get(vec, i - 1);
+            record_t *cur = (record_t*)vec_get(vec, i);
+            ck_assert(prev->key <= cur->key);
+            if (prev->key == cur->key) {
+                ck_assert(prev->seq < cur->seq);
+            }
+        }
+    }
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+// 按照模式pattern生成n个元素
+static int
+__pattern_value(int pattern, int i, int n)
+{
+    switch (pattern) {
+    case 0: return (int)(((long long)i * 7919) % n);  // 乱序
+    case 1: return i;                                   // 升序
+    case 2: return n - i;                               // 降序
+    case 3: return 42;                                  // 全部相等
+    case 4: return i % 5;                               // 少量不同的值
+    default: return (i < n / 2) ? i : n - i;            // 先升后降
+    }
+}
+
+static int
+__int_reverse_cmp(const void *lhs, const void *rhs)
+{
+    return __exact_int_cmp(rhs, lhs);
+}
+
+START_TEST(test_selection) {
+    static const int sizes[] = {0, 1, 2, 23, 24, 100, 129, 1000, 5000};
+    VEC *vec = int_vec_new();
+    VEC *sorted = int_vec_new();
+    VEC *top = int_vec_new();
+
+    for (int si = 0; si < ARRAY_SIZE(sizes, int); si++) {
+        int n = sizes[si];
+        for (int pattern = 0; pattern < 6; pattern++) {
+            vec_clear(sorted);
+            for (int i = 0; i < n; i++) {
+                int_vec_push_back(sorted, __pattern_value(pattern, i, n));
+            }
+            vec_sort(sorted, __exact_int_cmp);
+
+            // k取开头、结尾、中位数和p99
+            int ks[] = {0, n - 1, n / 2, n * 99 / 100, n};
+            for (int ki = 0; ki < ARRAY_SIZE(ks, int); ki++) {
+                int k = ks[ki];
+                if (k < 0) continue;
+
+                vec_clear(vec);
+                for (int i = 0; i < n; i++) {
+                    int_vec_push_back(vec, __pattern_value(pattern, i, n));
+                }
+                vec_nth_element(vec, k, __exact_int_cmp);
+                if (k < n) {
+                    int kth = *int_vec_get(vec, k);
+                    ck_assert_int_eq(*int_vec_get(sorted, k), kth);
+                    for (int i = 0; i < n; i++) {
+                        ck_assert(i < k ? *int_vec_get(vec, i) <= kth : *int_vec_get(vec, i) >= kth);
+                    }
+                }
+
+                vec_clear(vec);
+                for (int i = 0; i < n; i++) {
+                    int_vec_push_back(vec, __pattern_value(pattern, i, n));
+                }
+                vec_partial_sort(vec, k, __exact_int_cmp);
+                for (int i = 0; i < k && i < n; i++) {
+                    ck_assert_int_eq(*int_vec_get(sorted, i), *int_vec_get(vec, i));
+                }
+
+                // top_k不修改src，结果添加到dst已有的元素之后
+                vec_clear(top);
+                int_vec_push_back(top, -1);
+                vec_top_k(top, sorted, k, __exact_int_cmp);
+                ck_assert_int_eq((k < n ? k : n) + 1, vec_size(top));
+                ck_assert_int_eq(-1, *int_vec_get(top, 0));
+                for (int i = 0; i < k && i < n; i++) {
+                    ck_assert_int_eq(*int_vec_get(sorted, i), *int_vec_get(top, i + 1));
+                }
+            }
+        }
+    }
+
+    // 最大的3个数
+    vec_clear(vec);
+    vec_clear(top);
+    for (int i = 0; i < 100; i++) {
+        int_vec_push_back(vec, (i * 37) % 100);
+    }
+    int_vec_top_k(top, vec, 3);
+    ck_assert_int_eq(0, *int_vec_get(top, 0));
+    ck_assert_int_eq(2, *int_vec_get(top, 2));
+    vec_clear(top);
+    vec_top_k(top, vec, 3, __int_reverse_cmp);
+    ck_assert_int_eq(99, *int_vec_get(top, 0));
+    ck_assert_int_eq(97, *int_vec_get(top, 2));
+
+    vec_free(vec);
+    vec_free(sorted);
+    vec_free(top);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_view) {
+    VEC *vec = int_vec_new();
+    int arr[] = {9, 3, 7, 1, 5};
+    vec_view_t view, slice;
+    int value;
+
+    for (int i = 0; i < 100; i++) {
+        int_vec_push_back(vec, 99 - i);
+    }
+
+    // 只排序中间的一段，其余的元素不变
+    slice = vec_slice(vec, 10, 20);
+    ck_assert_int_eq(10, slice.len);
+    ck_assert(vec_view_get(slice, 0) == vec_get(vec, 10));
+    ck_assert(vec_view_get(slice, 10) == NULL);
+    vec_view_sort(slice, __exact_int_cmp);
+    for (int i = 0; i < 10; i++) {
+        ck_assert_int_eq(80 + i, *(int*)vec_view_get(slice, i));
+        ck_assert_int_eq(99 - i, *int_vec_get(vec, i));
+        ck_assert_int_eq(79 - i, *int_vec_get(vec, 20 + i));
+    }
+
+    value = 85;
+    ck_assert(vec_view_bin_find(slice, &value, __exact_int_cmp) == vec_get(vec, 15));
+    ck_assert_int_eq(5, vec_view_lower_bound(slice, &value, __exact_int_cmp));
+    ck_assert_int_eq(6, vec_view_upper_bound(slice, &value, __exact_int_cmp));
+    ck_assert(vec_view_find(slice, &value, CSTL_NUM_CMP_FUNC(int)) == vec_get(vec, 15));
+    value = 95;
+    ck_assert(vec_view_find(slice, &value, CSTL_NUM_CMP_FUNC(int)) == NULL);
+    ck_assert(vec_view_find(vec_view(vec), &value, CSTL_NUM_CMP_FUNC(int)) == vec_get(vec, 4));
+
+    // 切片的切片
+    slice = vec_view_slice(slice, 2, 5);
+    ck_assert_int_eq(3, slice.len);
+    ck_assert_int_eq(82, *(int*)vec_view_get(slice, 0));
+    slice = vec_view_slice(slice, 3, 3);
+    ck_assert_int_eq(0, slice.len);
+    vec_view_sort(slice, __exact_int_cmp);
+
+    // 外部的数组
+    view = vec_view_of(arr, ARRAY_SIZE(arr, int), sizeof(int));
+    vec_view_nth_element(view, 2, __exact_int_cmp);
+    ck_assert_int_eq(5, arr[2]);
+    vec_view_stable_sort(vec_view_slice(view, 0, 3), __exact_int_cmp);
+    ck_assert(arr[0] <= arr[1] && arr[1] <= arr[2]);
+    vec_view_sort(vec_view_of(NULL, 0, sizeof(int)), __exact_int_cmp);
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_adopt_release) {
+    int *buffer = (int*)cstl_malloc(sizeof(int) * 8);
+    VEC *vec;
+    size_t len;
+    int_small_vec_t svec;
+
+    for (int i = 0; i < 5; i++) {
+        buffer[i] = i;
+    }
+
+    // 接管内存，不复制
+    vec = vec_new_from_buffer(sizeof(int), NULL, buffer, 5, 8);
+    ck_assert_int_eq(5, vec_size(vec));
+    ck_assert_int_eq(8, vec_capacity(vec));
+    ck_assert(vec_get(vec, 0) == buffer);
+    for (int i = 5; i < 20; i++) {
+        int_vec_push_back(vec, i);
+    }
+
+    // 取走内存，不复制
+    buffer = (int*)vec->beg;
+    ck_assert(vec_release(vec, &len) == buffer);
+    ck_assert_int_eq(20, len);
+    ck_assert(vec_empty(vec));
+    for (int i = 0; i < 20; i++) {
+        ck_assert_int_eq(i, buffer[i]);
+    }
+    cstl_free(buffer);
+
+    // 取走之后vec仍然可以使用
+    int_vec_push_back(vec, 42);
+    ck_assert_int_eq(42, *int_vec_get(vec, 0));
+    buffer = (int*)vec_release(vec, NULL);
+    ck_assert_int_eq(42, buffer[0]);
+    cstl_free(buffer);
+    cstl_free(vec_release(vec, &len));
+    ck_assert_int_eq(0, len);
+    vec_free(vec);
+
+    // 内置存储中的元素会被复制出来
+    vec = int_small_vec_init(&svec);
+    int_vec_push_back(vec, 1);
+    int_vec_push_back(vec, 2);
+    buffer = (int*)vec_release(vec, &len);
+    ck_assert(buffer != svec.inline_data);
+    ck_assert_int_eq(2, len);
+    ck_assert_int_eq(2, buffer[1]);
+    ck_assert(vec_empty(vec));
+    ck_assert(vec->beg == svec.inline_data);
+    cstl_free(buffer);
+    int_small_vec_deinit(&svec);
+
+    ck_assert_no_leak();
+}
+END_TEST
+
+typedef struct {
+    int id;
+    double price;
+    long qty;
+    char flag;
+} order_t;
+
+#define ORDER_FIELDS(X) X(int, id) X(double, price) X(long, qty) X(char, flag)
+DEFINE_SOA_VEC(order, order_t, ORDER_FIELDS)
+
+static int
+__exact_long_cmp(const void *lhs, const void *rhs)
+{
+    long l = *(const long*)lhs, r = *(const long*)rhs;
+    return (l > r) - (l < r);
+}
+
+START_TEST(test_soa_vec) {
+    order_soa_t soa;
+    order_t row;
+    size_t indices[100];
+    long prev_qty = -1;
+    int prev_id = -1;
+
+    order_soa_init(&soa);
+    order_soa_reserve(&soa, 100);
+    ck_assert_int_eq(0, order_soa_size(&soa));
+
+    for (int i = 0; i < 100; i++) {
+        row.id = i;
+        row.price = i * 0.5;
+        row.qty = (i * 37) % 10;
+        row.flag = (char)('a' + i % 26);
+        order_soa_push_back(&soa, &row);
+    }
+    ck_assert_int_eq(100, order_soa_size(&soa));
+
+    // 每一列都是连续的普通vec
+    ck_assert_int_eq(100, vec_size(soa.price));
+    ck_assert(double_vec_sum(soa.price) == 99 * 100 / 2 * 0.5);
+    ck_assert_int_eq(4950, int_vec_sum(soa.id));
+    ck_assert_int_eq(10, long_vec_count(soa.qty, 3));
+
+    order_soa_get_row(&soa, 42, &row);
+    ck_assert_int_eq(42, row.id);
+    ck_assert(row.price == 21.0);
+    ck_assert_int_eq((42 * 37) % 10, row.qty);
+    ck_assert_int_eq('a' + 42 % 26, row.flag);
+
+    row.price = -1.0;
+    order_soa_set_row(&soa, 42, &row);
+    ck_assert(*double_vec_get(soa.price, 42) == -1.0);
+    ck_assert_int_eq(42, *int_vec_get(soa.id, 42));
+
+    // 按照qty排序，所有的列一起移动，相等的qty保持原来的顺序
+    vec_argsort(soa.qty, __exact_long_cmp, indices);
+    ck_assert_int_eq(0, indices[0]);
+    ck_assert_int_eq(10, indices[1]);
+    order_soa_sort_by(&soa, soa.qty, __exact_long_cmp);
+    for (size_t i = 0; i < order_soa_size(&soa); i++) {
+        order_soa_get_row(&soa, i, &row);
+        ck_assert(row.qty >= prev_qty);
+        if (row.qty == prev_qty) ck_assert(row.id > prev_id);
+        ck_assert_int_eq((row.id * 37) % 10, row.qty);
+        ck_assert_int_eq('a' + row.id % 26, row.flag);
+        ck_assert(row.price == (row.id == 42 ? -1.0 : row.id * 0.5));
+        prev_qty = row.qty;
+        prev_id = row.id;
+    }
+
+    // 按照id恢复原来的顺序
+    order_soa_sort_by(&soa, soa.id, __exact_int_cmp);
+    for (int i = 0; i < 100; i++) {
+        ck_assert_int_eq(i, *int_vec_get(soa.id, i));
+    }
+
+    order_soa_clear(&soa);
+    ck_assert_int_eq(0, order_soa_size(&soa));
+    order_soa_deinit(&soa);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_unchecked_access) {
+    VEC *vec = int_vec_new();
+    long sum = 0;
+
+    for (int i = 0; i < 100; i++) {
+        int_vec_push_back(vec, i);
+    }
+    ck_assert_int_eq(vec_size(vec), vec_len(vec));
+    ck_assert(vec_data(vec) == vec_get(vec, 0));
+    ck_assert(int_vec_data(vec) == int_vec_get(vec, 0));
+
+    // 直接在连续的内存上循环
+    int *data = int_vec_data(vec);
+    for (size_t i = 0; i < vec_len(vec); i++) {
+        sum += data[i];
+    }
+    ck_assert_int_eq(4950, sum);
+
+    for (size_t i = 0; i < vec_len(vec); i++) {
+        ck_assert(int_vec_get_unchecked(vec, i) == int_vec_get(vec, i));
+        *int_vec_get_unchecked(vec, i) *= 2;
+    }
+    ck_assert_int_eq(198, *int_vec_back(vec));
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
 START_TEST(test_swap) {
     VEC *vec = vec_new(sizeof(int), NULL);
     int data = 1;
@@ -884,6 +1739,105 @@ START_TEST(test_bin_find)
 }
 END_TEST
 
+static void
+__check_int_vec(VEC *vec, const int *expect, int count)
+{
+    ck_assert_int_eq(count, vec_size(vec));
+    for (int i = 0; i < count; i++) {
+        ck_assert_int_eq(expect[i], *(int*)vec_get(vec, i));
+    }
+}
+
+START_TEST(test_sorted_set_ops) {
+    int a_data[] = {1, 2, 2, 3, 5, 7};
+    int b_data[] = {2, 3, 3, 4, 7, 8};
+    int merged[] = {1, 2, 2, 2, 3, 3, 3, 4, 5, 7, 7, 8};
+    int unioned[] = {1, 2, 2, 3, 3, 4, 5, 7, 8};
+    int intersected[] = {2, 3, 7};
+    int differed[] = {1, 2, 5};
+    int uniqued[] = {1, 2, 3, 4, 5, 7, 8};
+    cmp_func_t cmp = CSTL_NUM_CMP_FUNC(int);
+    VEC *a = vec_new(sizeof(int), NULL);
+    VEC *b = vec_new(sizeof(int), NULL);
+    VEC *dst = vec_new(sizeof(int), NULL);
+    int val;
+
+    vec_append_array(a, a_data, ARRAY_SIZE(a_data, int));
+    vec_append_array(b, b_data, ARRAY_SIZE(b_data, int));
+
+    vec_merge_sorted(dst, a, b, cmp);
+    __check_int_vec(dst, merged, ARRAY_SIZE(merged, int));
+
+    // 查找边界
+    val = 3;
+    ck_assert_int_eq(4, vec_lower_bound(dst, &val, cmp));
+    ck_assert_int_eq(7, vec_upper_bound(dst, &val, cmp));
+    val = 6;
+    ck_assert_int_eq(9, vec_lower_bound(dst, &val, cmp));
+    ck_assert_int_eq(9, vec_upper_bound(dst, &val, cmp));
+    val = 0;
+    ck_assert_int_eq(0, vec_lower_bound(dst, &val, cmp));
+    val = 9;
+    ck_assert_int_eq(12, vec_upper_bound(dst, &val, cmp));
+
+    ck_assert_int_eq(5, vec_unique(dst, cmp));
+    __check_int_vec(dst, uniqued, ARRAY_SIZE(uniqued, int));
+    ck_assert_int_eq(0, vec_unique(dst, cmp));
+
+    vec_clear(dst);
+    vec_set_union(dst, a, b, cmp);
+    __check_int_vec(dst, unioned, ARRAY_SIZE(unioned, int));
+
+    vec_clear(dst);
+    vec_set_intersection(dst, a, b, cmp);
+    __check_int_vec(dst, intersected, ARRAY_SIZE(intersected, int));
+
+    // 结果是追加到dst尾部的
+    vec_clear(dst);
+    val = -1;
+    vec_push_back(dst, &val);
+    vec_set_difference(dst, a, b, cmp);
+    ck_assert_int_eq(-1, *(int*)vec_front(dst));
+    vec_erase(dst, 0);
+    __check_int_vec(dst, differed, ARRAY_SIZE(differed, int));
+
+    vec_free(a);
+    vec_free(b);
+    vec_free(dst);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_merge_sorted_stable) {
+    VEC *a = vec_new(sizeof(record_t), NULL);
+    VEC *b = vec_new(sizeof(record_t), NULL);
+    VEC *dst = vec_new(sizeof(record_t), NULL);
+    record_t rec;
+
+    // a中元素的seq是0，b中元素的seq是1
+    for (int i = 0; i < 10; i++) {
+        rec.key = i / 2;
+        rec.seq = 0;
+        vec_push_back(a, &rec);
+        rec.seq = 1;
+        vec_push_back(b, &rec);
+    }
+
+    vec_merge_sorted(dst, a, b, __record_key_cmp);
+    ck_assert_int_eq(20, vec_size(dst));
+    for (int i = 0; i < 20; i++) {
+        record_t *r = (record_t*)vec_get(dst, i);
+        ck_assert_int_eq(i / 4, r->key);
+        ck_assert_int_eq((i % 4) / 2, r->seq);
+    }
+
+    vec_free(a);
+    vec_free(b);
+    vec_free(dst);
+    ck_assert_no_leak();
+}
+END_TEST
+
 static void int_ptr_destroy(int **elem)
 {
     cstl_free(*elem);
@@ -911,23 +1865,39 @@ START_DEFINE_SUITE(vec)
     TEST(test_push_front)
     TEST(test_push_back)
     TEST(test_resize)
+    TEST(test_capacity)
+    TEST(test_small_vec)
     TEST(test_pop_back)
     TEST(test_pop_front)
     TEST(test_front_back_get)
     TEST(test_find)
     TEST(test_insert)
     TEST(test_extend)
+    TEST(test_insert_array)
     TEST(test_assign)
     TEST(test_erase)
     TEST(test_clear)
     TEST(test_remove)
     TEST(test_remove_all)
+    TEST(test_batch_remove)
     TEST(test_sort)
+    TEST(test_sort_patterns)
+    TEST(test_radix_sort)
+    TEST(test_stable_sort)
+    TEST(test_sort_parallel)
+    TEST(test_parallel_foreach_reduce)
+    TEST(test_selection)
+    TEST(test_view)
+    TEST(test_adopt_release)
+    TEST(test_soa_vec)
+    TEST(test_unchecked_access)
     TEST(test_swap)
     TEST(test_vec_num_compare)
     TEST(test_vec_type_macro)
     TEST(test_struct_vec)
     TEST(test_bin_find)
+    TEST(test_sorted_set_ops)
+    TEST(test_merge_sorted_stable)
     TEST(test_destory_func)
 END_DEFINE_SUITE()
 
@@ -0,0 +1,256 @@
+/********************************************************
+* Description: @description@
+* Author: twoflyliu
+* Mail: twoflyliu@163.com
+* Create time: 2026 10 19 16:05:12
+*/
+#include <check_util.h>
+#include <limits.h>
+#include <string.h>
+
+#include "vec_num.h"
+#include "test_common.h"
+
+// 使用各种长度，覆盖向量化的主循环和尾部的标量部分，元素是(i * 71) % len，71和所有长度互质，所以没有重复
+#define MAX_LEN 70
+
+START_TEST(test_int_search) {
+    VEC *vec = int_vec_new();
+    int min, max;
+
+    ck_assert(!int_vec_min(vec, &min));
+    ck_assert(!int_vec_max(vec, &max));
+    ck_assert_int_eq(0, int_vec_index_of(vec, 1));
+    ck_assert(!int_vec_contains(vec, 1));
+
+    for (int len = 1; len <= MAX_LEN; len++) {
+        vec_clear(vec);
+        for (int i = 0; i < len; i++) {
+            int_vec_push_back(vec, (i * 71) % len - len / 2);
+        }
+
+        for (int pos = 0; pos < len; pos++) {
+            int value = *int_vec_get(vec, pos);
+            ck_assert_int_eq(pos, int_vec_index_of(vec, value));
+            ck_assert_int_eq(1, int_vec_count(vec, value));
+            ck_assert(int_vec_find(vec, value) == int_vec_get(vec, pos));
+        }
+        ck_assert_int_eq(len, int_vec_index_of(vec, 1000));
+        ck_assert(int_vec_find(vec, 1000) == NULL);
+
+        ck_assert(int_vec_min(vec, &min));
+        ck_assert(int_vec_max(vec, &max));
+        ck_assert_int_eq(-(len / 2), min);
+        ck_assert_int_eq(len - 1 - len / 2, max);
+    }
+
+    // 重复的元素
+    vec_clear(vec);
+    for (int i = 0; i < 1000; i++) {
+        int_vec_push_back(vec, i % 7);
+    }
+    ck_assert_int_eq(143, int_vec_count(vec, 0));
+    ck_assert_int_eq(142, int_vec_count(vec, 6));
+    ck_assert_int_eq(3, int_vec_index_of(vec, 3));
+    ck_assert(int_vec_contains(vec, 6));
+    ck_assert(!int_vec_contains(vec, 7));
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_long_search) {
+    VEC *vec = long_vec_new();
+    long min, max;
+    long big = (long)1 << (sizeof(long) * 8 - 2);
+
+    for (int len = 1; len <= MAX_LEN; len++) {
+        vec_clear(vec);
+        for (int i = 0; i < len; i++) {
+            long_vec_push_back(vec, (i % 2) ? big + i : -big - i);
+        }
+        ck_assert(long_vec_min(vec, &min));
+        ck_assert(long_vec_max(vec, &max));
+        ck_assert(min == -big - ((len - 1) / 2 * 2));
+        ck_assert(max == ((len > 1) ? big + ((len - 2) / 2 * 2 + 1) : -big));
+        ck_assert_int_eq(len - 1, long_vec_index_of(vec, *long_vec_get(vec, len - 1)));
+        ck_assert_int_eq(1, long_vec_count(vec, *long_vec_get(vec, len - 1)));
+    }
+
+    // 差值的低32位相等的两个数，不能被认为是相等的
+    if (sizeof(long) > 4) {
+        vec_clear(vec);
+        long_vec_push_back(vec, big);
+        ck_assert(long_vec_find(vec, big + ((long)1 << 32)) == NULL);
+        ck_assert(long_vec_find(vec, big) != NULL);
+    }
+
+    vec_free(vec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_float_search) {
+    VEC *fvec = float_vec_new();
+    VEC *dvec = double_vec_new();
+    float fmin, fmax;
+    double dmin, dmax;
+
+    for (int len = 1; len <= MAX_LEN; len++) {
+        vec_clear(fvec);
+        vec_clear(dvec);
+        for (int i = 0; i < len; i++) {
+            float_vec_push_back(fvec, (float)((i * 71) % len) - 0.5f);
+            double_vec_push_back(dvec, ((i * 71) % len) * -0.25);
+        }
+
+        ck_assert(float_vec_min(fvec, &fmin));
+        ck_assert(float_vec_max(fvec, &fmax));
+        ck_assert(fmin == -0.5f);
+        ck_assert(fmax == len - 1.5f);
+
+        ck_assert(double_vec_min(dvec, &dmin));
+        ck_assert(double_vec_max(dvec, &dmax));
+        ck_assert(dmin == (len - 1) * -0.25);
+        ck_assert(dmax == 0.0);
+
+        for (int pos = 0; pos < len; pos++) {
+            ck_assert_int_eq(pos, float_vec_index_of(fvec, *float_vec_get(fvec, pos)));
+            ck_assert_int_eq(pos, double_vec_index_of(dvec, *double_vec_get(dvec, pos)));
+        }
+        ck_assert(!float_vec_contains(fvec, 0.25f));
+        ck_assert_int_eq(0, double_vec_count(dvec, 0.1));
+    }
+
+    ck_assert(strcmp(vec_num_isa(), "avx2") == 0 || strcmp(vec_num_isa(), "scalar") == 0);
+
+    vec_free(fvec);
+    vec_free(dvec);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_int_arith) {
+    VEC *a = int_vec_new();
+    VEC *b = int_vec_new();
+    long long sum, dot;
+
+    ck_assert(int_vec_sum(a) == 0);
+    ck_assert(int_vec_dot(a, b) == 0);
+    int_vec_prefix_sum(a);
+    int_vec_clamp(a, 0, 1);
+    ck_assert_int_eq(0, vec_size(a));
+
+    for (int len = 1; len <= MAX_LEN; len++) {
+        vec_clear(a);
+        vec_clear(b);
+        sum = dot = 0;
+        for (int i = 0; i < len; i++) {
+            int x = (i * 71) % len - len / 2;
+            int_vec_push_back(a, x);
+            int_vec_push_back(b, i);
+            sum += x;
+            dot += (long long)x * i;
+        }
+        ck_assert(int_vec_sum(a) == sum);
+        ck_assert(int_vec_dot(a, b) == dot);
+
+        // b变为 i * 3 + 1，再加上自身变为 i * 6 + 2
+        int_vec_scale(b, 3);
+        int_vec_add_scalar(b, 1);
+        int_vec_add(b, b);
+        // a变为 a[i] + b[i]
+        int_vec_add(a, b);
+        for (int i = 0; i < len; i++) {
+            ck_assert_int_eq(i * 6 + 2, *int_vec_get(b, i));
+            ck_assert_int_eq((i * 71) % len - len / 2 + i * 6 + 2, *int_vec_get(a, i));
+        }
+
+        int_vec_clamp(b, 10, 20);
+        int_vec_prefix_sum(b);
+        sum = 0;
+        for (int i = 0; i < len; i++) {
+            int x = i * 6 + 2;
+            sum += (x < 10) ? 10 : (x > 20 ? 20 : x);
+            ck_assert(*int_vec_get(b, i) == sum);
+        }
+    }
+
+    // 累加使用long long，不会溢出
+    vec_clear(a);
+    for (int i = 0; i < 100; i++) {
+        int_vec_push_back(a, INT_MAX);
+    }
+    ck_assert(int_vec_sum(a) == 100LL * INT_MAX);
+    int_vec_clamp(a, 0, 65536);
+    ck_assert(int_vec_dot(a, a) == 100LL * 65536 * 65536);
+
+    vec_free(a);
+    vec_free(b);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_TEST(test_float_arith) {
+    VEC *fa = float_vec_new();
+    VEC *fb = float_vec_new();
+    VEC *da = double_vec_new();
+    VEC *la = long_vec_new();
+    double sum, dot;
+
+    // 元素都是可以被精确表示的数，所以累加的顺序不影响结果
+    for (int len = 1; len <= MAX_LEN; len++) {
+        vec_clear(fa);
+        vec_clear(fb);
+        vec_clear(da);
+        vec_clear(la);
+        sum = dot = 0;
+        for (int i = 0; i < len; i++) {
+            float x = (float)((i * 71) % len) - 0.5f;
+            float_vec_push_back(fa, x);
+            float_vec_push_back(fb, 0.25f * i);
+            double_vec_push_back(da, x * 2.0);
+            long_vec_push_back(la, -i);
+            sum += x;
+            dot += x * 0.25 * i;
+        }
+        ck_assert(float_vec_sum(fa) == sum);
+        ck_assert(float_vec_dot(fa, fb) == dot);
+        ck_assert(double_vec_sum(da) == sum * 2);
+        ck_assert(double_vec_dot(da, da) == 4 * float_vec_dot(fa, fa));
+        ck_assert(long_vec_sum(la) == -(long long)len * (len - 1) / 2);
+
+        float_vec_clamp(fa, 0.0f, 10.0f);
+        double_vec_scale(da, 0.5);
+        double_vec_add_scalar(da, 1.0);
+        double_vec_prefix_sum(da);
+        long_vec_scale(la, -2);
+        long_vec_prefix_sum(la);
+        sum = 0;
+        for (int i = 0; i < len; i++) {
+            float x = (float)((i * 71) % len) - 0.5f;
+            ck_assert(*float_vec_get(fa, i) == ((x < 0) ? 0.0f : (x > 10 ? 10.0f : x)));
+            sum += x + 1.0;
+            ck_assert(*double_vec_get(da, i) == sum);
+            ck_assert(*long_vec_get(la, i) == (long)i * (i + 1));
+        }
+    }
+
+    vec_free(fa);
+    vec_free(fb);
+    vec_free(da);
+    vec_free(la);
+    ck_assert_no_leak();
+}
+END_TEST
+
+START_DEFINE_SUITE(vec_num)
+    TEST(test_int_search)
+    TEST(test_long_search)
+    TEST(test_float_search)
+    TEST(test_int_arith)
+    TEST(test_float_arith)
+END_DEFINE_SUITE()
+
+#undef MAX_LEN